@@ -33,11 +33,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <errno.h>
 
 #include "cver_compat.h"
 
 
+/* ポインタテーブルの一括加算に使う SIMD 命令セット (64ビット環境のみ) */
+#if defined (__AVX2__) && (defined (__x86_64__) || defined (_M_X64))
+	#include <immintrin.h>
+	#define ANDA_REBASE_AVX2
+#elif defined (__SSE2__) && (defined (__x86_64__) || defined (_M_X64))
+	#include <emmintrin.h>
+	#define ANDA_REBASE_SSE2
+#elif defined (__aarch64__) && defined (__ARM_NEON)
+	#include <arm_neon.h>
+	#define ANDA_REBASE_NEON
+#endif
+
+
 #undef malloc
 #undef calloc
 #undef free
@@ -81,9 +95,15 @@ size_t anda_align_up (size_t value, size_t alignment) {
 }
 
 
-/* 注意: *result_ptrs_size は *result_padding_size を「含まない」ので注意が必要 */
-bool calculate_nd_array_size (const size_t sizes[], size_t dims, size_t elem_size, size_t* result_ptrs_size, size_t* result_padding_size, size_t* result_total_elements) {
-	if (elem_size == 0 || dims == 0 || result_ptrs_size == PTR_NULL ||
+/* 形状の d 番目の次元を読む (ANDA_SHAPE_REVERSED なら sizes を逆順に読む) */
+static inline size_t shape_at (const size_t sizes[], size_t dims, size_t d, unsigned int flags) {
+	return (flags & ANDA_SHAPE_REVERSED) ? sizes[dims - 1 - d] : sizes[d];
+}
+
+
+/* 最上位次元の大きさを outer に置き換えた形状としてサイズを計算する (容量を予約した配列で使用) */
+static bool calculate_size_with_outer (const size_t sizes[], size_t dims, size_t outer, size_t elem_size, unsigned int flags, size_t* result_ptrs_size, size_t* result_padding_size, size_t* result_total_elements) {
+	if (elem_size == 0 || dims == 0 || (flags & ~ANDA_SHAPE_REVERSED) != 0 || result_ptrs_size == PTR_NULL ||
 		result_padding_size == PTR_NULL || result_total_elements == PTR_NULL) {
 		errno = EINVAL;
 		anda_errfunc = "calculate_nd_array_size";
@@ -95,13 +115,13 @@ bool calculate_nd_array_size (const size_t sizes[], size_t dims, size_t elem_siz
 	*result_total_elements = 1;
 
 	if (dims == 1) {  /* 1次元 (ただの配列) の場合はそのまま掛け算でサイズを求めて返却 */
-		if (sizes[0] == 0 || sizes[0] > (SIZE_MAX / elem_size)) {
+		if (outer == 0 || outer > (SIZE_MAX / elem_size)) {
 			errno = EINVAL;
 			anda_errfunc = "calculate_nd_array_size";
 			return false;
 		}
 
-		*result_total_elements = sizes[0];
+		*result_total_elements = outer;
 		return true;
 	}
 
@@ -109,12 +129,13 @@ bool calculate_nd_array_size (const size_t sizes[], size_t dims, size_t elem_siz
 	size_t total_elements = 1;
 	size_t total_ptrs = 0;
 	for (size_t i = 0; i < dims; i++) {
-		if (sizes[i] == 0 || total_elements > (SIZE_MAX / sizes[i])) {
+		size_t size = (i == 0) ? outer : shape_at(sizes, dims, i, flags);
+		if (size == 0 || total_elements > (SIZE_MAX / size)) {
 			errno = EINVAL;
 			anda_errfunc = "calculate_nd_array_size";
 			return false;
 		}
-		total_elements *= sizes[i];
+		total_elements *= size;
 
 		if (i < dims - 1)  /* 最下層以外はポインタ数を加算 */
 			total_ptrs += total_elements;
@@ -149,33 +170,39 @@ bool calculate_nd_array_size (const size_t sizes[], size_t dims, size_t elem_siz
 }
 
 
-void* allocate_and_initialize_nd_array (const size_t sizes[], size_t dims, size_t elem_size, size_t size_ptrs, size_t size_padding, size_t total_elements, allocFuncPtr alloc_func) {
-	if (dims == 1) {  /* 1次元 (ただの配列) の場合はそのまま malloc に渡す */
-		void* ptr = alloc_func(total_elements * elem_size);
-		if (UNLIKELY(ptr == PTR_NULL)) {
-			errno = ENOMEM;
-			anda_errfunc = "allocate_and_initialize_nd_array";
-			return PTR_NULL;
-		}
-		return ptr;
+/* 注意: *result_ptrs_size は *result_padding_size を「含まない」ので注意が必要 */
+bool calculate_nd_array_size (const size_t sizes[], size_t dims, size_t elem_size, size_t* result_ptrs_size, size_t* result_padding_size, size_t* result_total_elements) {
+	if (sizes == PTR_NULL || dims == 0) {
+		errno = EINVAL;
+		anda_errfunc = "calculate_nd_array_size";
+		return false;
 	}
+	return calculate_size_with_outer(sizes, dims, sizes[0], elem_size, 0, result_ptrs_size, result_padding_size, result_total_elements);
+}
 
-	/* メモリブロックを確保 */
-	void** base = alloc_func(size_ptrs + size_padding + (total_elements * elem_size));
-	if (UNLIKELY(base == PTR_NULL)) {
-		errno = ENOMEM;
-		anda_errfunc = "allocate_and_initialize_nd_array";
-		return PTR_NULL;
+
+bool calculate_nd_array_size_ex (const size_t sizes[], size_t dims, size_t elem_size, unsigned int flags, size_t* result_ptrs_size, size_t* result_padding_size, size_t* result_total_elements) {
+	if (sizes == PTR_NULL || dims == 0) {
+		errno = EINVAL;
+		anda_errfunc = "calculate_nd_array_size_ex";
+		return false;
 	}
+	return calculate_size_with_outer(sizes, dims, shape_at(sizes, dims, 0, flags), elem_size, flags, result_ptrs_size, result_padding_size, result_total_elements);
+}
+
+
+static void* initialize_impl (void* block, const size_t sizes[], size_t dims, size_t elem_size, unsigned int flags, size_t size_ptrs, size_t size_padding, size_t total_elements) {
+	if (dims == 1) return block;  /* 1次元 (ただの配列) の場合はポインタテーブルが存在しない */
 
+	void** base = block;
 	void** ptr = base;  /* ポインタの開始位置を格納 */
 
 	if (dims != 2) {  /* 3次元以上の時だけ実行 */
 		/* 最下層を除くポインタ位置を設定 (下層もポインタであるため、そのまま加算) */
 		size_t curr_level = 1;
 		for (size_t d = 0; d < dims - 2; d++) {
-			curr_level *= sizes[d];
-			size_t next_level = sizes[d + 1];
+			curr_level *= shape_at(sizes, dims, d, flags);
+			size_t next_level = shape_at(sizes, dims, d + 1, flags);
 
 			for (size_t i = 0; i < curr_level; i++) {
 				ptr[i] = (void*)(ptr + curr_level + (i * next_level));
@@ -186,11 +213,106 @@ void* allocate_and_initialize_nd_array (const size_t sizes[], size_t dims, size_
 
 	/* 最下層のポインタ位置を設定 (下層は実データであるため、elem_sizeを掛けて計算) */
 	char* data = (char*)(base) + size_ptrs + size_padding;
-	for (size_t i = 0; i < total_elements / sizes[dims - 1]; i++) {
-		ptr[i] = data + ((i * sizes[dims - 1]) * elem_size);
+	size_t row = shape_at(sizes, dims, dims - 1, flags);
+	for (size_t i = 0; i < total_elements / row; i++) {
+		ptr[i] = data + ((i * row) * elem_size);
+	}
+
+	return block;
+}
+
+
+void* initialize_nd_array (void* block, const size_t sizes[], size_t dims, size_t elem_size, size_t size_ptrs, size_t size_padding, size_t total_elements) {
+	return initialize_impl(block, sizes, dims, elem_size, 0, size_ptrs, size_padding, total_elements);
+}
+
+
+void* initialize_nd_array_ex (void* block, const size_t sizes[], size_t dims, size_t elem_size, unsigned int flags, size_t size_ptrs, size_t size_padding, size_t total_elements) {
+	return initialize_impl(block, sizes, dims, elem_size, flags, size_ptrs, size_padding, total_elements);
+}
+
+
+void rebase_pointer_table (void** table, size_t count, const void* old_base, const void* new_base) {
+	uintptr_t delta = (uintptr_t)new_base - (uintptr_t)old_base;  /* 符号なしの剰余演算なので後方への移動もそのまま扱える */
+	if (table == PTR_NULL || delta == 0) return;
+
+	size_t i = 0;
+#if defined (ANDA_REBASE_AVX2)
+	__m256i vdelta = _mm256_set1_epi64x((long long)delta);
+	for (; i + 8 <= count; i += 8) {
+		__m256i a = _mm256_loadu_si256((const __m256i*)(void*)(table + i));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(void*)(table + i + 4));
+		_mm256_storeu_si256((__m256i*)(void*)(table + i), _mm256_add_epi64(a, vdelta));
+		_mm256_storeu_si256((__m256i*)(void*)(table + i + 4), _mm256_add_epi64(b, vdelta));
+	}
+#elif defined (ANDA_REBASE_SSE2)
+	__m128i vdelta = _mm_set1_epi64x((long long)delta);
+	for (; i + 8 <= count; i += 8) {
+		__m128i a = _mm_loadu_si128((const __m128i*)(void*)(table + i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(void*)(table + i + 2));
+		__m128i c = _mm_loadu_si128((const __m128i*)(void*)(table + i + 4));
+		__m128i d = _mm_loadu_si128((const __m128i*)(void*)(table + i + 6));
+		_mm_storeu_si128((__m128i*)(void*)(table + i), _mm_add_epi64(a, vdelta));
+		_mm_storeu_si128((__m128i*)(void*)(table + i + 2), _mm_add_epi64(b, vdelta));
+		_mm_storeu_si128((__m128i*)(void*)(table + i + 4), _mm_add_epi64(c, vdelta));
+		_mm_storeu_si128((__m128i*)(void*)(table + i + 6), _mm_add_epi64(d, vdelta));
+	}
+#elif defined (ANDA_REBASE_NEON)
+	uint64x2_t vdelta = vdupq_n_u64((uint64_t)delta);
+	for (; i + 8 <= count; i += 8) {
+		uint64_t* p = (uint64_t*)(void*)(table + i);
+		vst1q_u64(p, vaddq_u64(vld1q_u64(p), vdelta));
+		vst1q_u64(p + 2, vaddq_u64(vld1q_u64(p + 2), vdelta));
+		vst1q_u64(p + 4, vaddq_u64(vld1q_u64(p + 4), vdelta));
+		vst1q_u64(p + 6, vaddq_u64(vld1q_u64(p + 6), vdelta));
+	}
+#endif
+
+	for (; i < count; i++) {  /* 端数 (または SIMD が使えない環境での全体) */
+		table[i] = (void*)((uintptr_t)table[i] + delta);
+	}
+}
+
+
+void* rebase_nd_array (void* block, const void* old_base, const size_t sizes[], size_t dims, size_t elem_size) {
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_nd_array_size(sizes, dims, elem_size, &size_ptrs, &size_padding, &total_elements)) {
+		anda_errfunc = "rebase_nd_array";
+		return PTR_NULL;
+	}
+
+	if (block == PTR_NULL) {
+		errno = EINVAL;
+		anda_errfunc = "rebase_nd_array";
+		return PTR_NULL;
 	}
 
-	return (void*)base;
+	/* 全てのポインタはブロック内を指しているので、移動量を一律に足せば済む */
+	rebase_pointer_table(block, size_ptrs / sizeof(void*), old_base, block);
+	return block;
+}
+
+
+void* allocate_and_initialize_nd_array (const size_t sizes[], size_t dims, size_t elem_size, size_t size_ptrs, size_t size_padding, size_t total_elements, allocFuncPtr alloc_func) {
+	if (dims == 1) {  /* 1次元 (ただの配列) の場合はそのまま malloc に渡す */
+		void* ptr = alloc_func(total_elements * elem_size);
+		if (UNLIKELY(ptr == PTR_NULL)) {
+			errno = ENOMEM;
+			anda_errfunc = "allocate_and_initialize_nd_array";
+			return PTR_NULL;
+		}
+		return ptr;
+	}
+
+	/* メモリブロックを確保 */
+	void* base = alloc_func(size_ptrs + size_padding + (total_elements * elem_size));
+	if (UNLIKELY(base == PTR_NULL)) {
+		errno = ENOMEM;
+		anda_errfunc = "allocate_and_initialize_nd_array";
+		return PTR_NULL;
+	}
+
+	return initialize_nd_array(base, sizes, dims, elem_size, size_ptrs, size_padding, total_elements);
 }
 
 
@@ -226,6 +348,279 @@ void* calloc_nd_array (const size_t sizes[], size_t dims, size_t elem_size) {
 }
 
 
+/* 形状の変化の向き: 全次元が拡大 (または不変) なら 1、全次元が縮小 (または不変) なら -1、混在なら 0 */
+static int resize_direction (const size_t old_sizes[], const size_t new_sizes[], size_t dims) {
+	bool grows = false, shrinks = false;
+	for (size_t d = 0; d < dims; d++) {
+		if (new_sizes[d] > old_sizes[d]) grows = true;
+		else if (new_sizes[d] < old_sizes[d]) shrinks = true;
+	}
+
+	if (grows && shrinks) return 0;
+	return shrinks ? -1 : 1;
+}
+
+
+void* relayout_nd_array (void* dst_block, void* src_block, const size_t old_sizes[], const size_t new_sizes[], size_t dims, size_t elem_size, bool zero_fill) {
+	size_t old_ptrs, old_padding, old_total, new_ptrs, new_padding, new_total;
+	if (dst_block == PTR_NULL || src_block == PTR_NULL ||
+		!calculate_nd_array_size(old_sizes, dims, elem_size, &old_ptrs, &old_padding, &old_total) ||
+		!calculate_nd_array_size(new_sizes, dims, elem_size, &new_ptrs, &new_padding, &new_total)) {
+		errno = EINVAL;
+		anda_errfunc = "relayout_nd_array";
+		return PTR_NULL;
+	}
+
+	int direction = resize_direction(old_sizes, new_sizes, dims);
+	bool in_place = (dst_block == src_block);
+	if (in_place && direction == 0) {  /* 同じブロック内では行の移動順序を決められない */
+		errno = EINVAL;
+		anda_errfunc = "relayout_nd_array";
+		return PTR_NULL;
+	}
+
+	char* src_data = (char*)src_block + old_ptrs + old_padding;
+	char* dst_data = (char*)dst_block + new_ptrs + new_padding;
+	size_t old_row_size = old_sizes[dims - 1] * elem_size;
+	size_t new_row_size = new_sizes[dims - 1] * elem_size;
+	size_t copy_size = (old_row_size < new_row_size) ? old_row_size : new_row_size;
+	size_t rows = new_total / new_sizes[dims - 1];
+
+	/* 同じブロック内で拡大する場合は、未処理の行を上書きしないよう末尾の行から移動する */
+	bool descending = in_place && direction > 0;
+
+	for (size_t n = 0; n < rows; n++) {
+		size_t row = descending ? (rows - 1 - n) : n;
+
+		/* 新しい形状での行番号を添字に分解し、元の形状での行番号を求める */
+		size_t rest = row, src_row = 0, stride = 1;
+		bool inside = true;
+		for (size_t d = dims - 1; d > 0; d--) {
+			size_t index = rest % new_sizes[d - 1];
+			rest /= new_sizes[d - 1];
+			if (index >= old_sizes[d - 1]) {
+				inside = false;
+				break;
+			}
+			src_row += index * stride;
+			stride *= old_sizes[d - 1];
+		}
+
+		char* dst = dst_data + (row * new_row_size);
+		if (inside) {
+			char* src = src_data + (src_row * old_row_size);
+			if (dst != src) memmove(dst, src, copy_size);
+			if (zero_fill && new_row_size > copy_size) memset(dst + copy_size, 0, new_row_size - copy_size);
+		} else if (zero_fill) {
+			memset(dst, 0, new_row_size);
+		}
+	}
+
+	return initialize_nd_array(dst_block, new_sizes, dims, elem_size, new_ptrs, new_padding, new_total);
+}
+
+
+static void* realloc_nd_array_impl (void* array, const size_t old_sizes[], const size_t new_sizes[], size_t dims, size_t elem_size, bool zero_fill) {
+	size_t old_ptrs, old_padding, old_total, new_ptrs, new_padding, new_total;
+	if (!calculate_nd_array_size(old_sizes, dims, elem_size, &old_ptrs, &old_padding, &old_total) ||
+		!calculate_nd_array_size(new_sizes, dims, elem_size, &new_ptrs, &new_padding, &new_total)) {
+		return PTR_NULL;
+	}
+
+	size_t new_size = new_ptrs + new_padding + (new_total * elem_size);
+	int direction = resize_direction(old_sizes, new_sizes, dims);
+
+	if (direction > 0) {  /* 拡大: 先にブロックを広げてから、その中で行を後ろへずらす */
+		void* block = realloc(array, new_size);
+		if (UNLIKELY(block == PTR_NULL)) {
+			errno = ENOMEM;
+			return PTR_NULL;
+		}
+		return relayout_nd_array(block, block, old_sizes, new_sizes, dims, elem_size, zero_fill);
+	}
+
+	if (direction < 0) {  /* 縮小: 先に行を前へ詰めてから、ブロックを縮める */
+		relayout_nd_array(array, array, old_sizes, new_sizes, dims, elem_size, zero_fill);
+		void* block = realloc(array, new_size);
+		if (block == PTR_NULL) return array;  /* 縮小に失敗しても配列としては有効 */
+		if (block != array)  /* 移動した場合はポインタテーブルを作り直す */
+			initialize_nd_array(block, new_sizes, dims, elem_size, new_ptrs, new_padding, new_total);
+		return block;
+	}
+
+	/* 拡大と縮小が混在する場合は、新しいブロックへ行ごとにコピーする */
+	void* block = malloc(new_size);
+	if (UNLIKELY(block == PTR_NULL)) {
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+	relayout_nd_array(block, array, old_sizes, new_sizes, dims, elem_size, zero_fill);
+	free(array);
+	return block;
+}
+
+
+void* realloc_nd_array (void* array, const size_t old_sizes[], const size_t new_sizes[], size_t dims, size_t elem_size) {
+	if (array == PTR_NULL) {
+		void* ptr = alloc_nd_array(new_sizes, dims, elem_size);
+		if (ptr == PTR_NULL) anda_errfunc = "realloc_nd_array";
+		return ptr;
+	}
+
+	void* ptr = realloc_nd_array_impl(array, old_sizes, new_sizes, dims, elem_size, false);
+	if (ptr == PTR_NULL) {
+		anda_errfunc = "realloc_nd_array";
+		return PTR_NULL;
+	}
+	return ptr;
+}
+
+
+void* recalloc_nd_array (void* array, const size_t old_sizes[], const size_t new_sizes[], size_t dims, size_t elem_size) {
+	if (array == PTR_NULL) {
+		void* ptr = calloc_nd_array(new_sizes, dims, elem_size);
+		if (ptr == PTR_NULL) anda_errfunc = "recalloc_nd_array";
+		return ptr;
+	}
+
+	void* ptr = realloc_nd_array_impl(array, old_sizes, new_sizes, dims, elem_size, true);
+	if (ptr == PTR_NULL) {
+		anda_errfunc = "recalloc_nd_array";
+		return PTR_NULL;
+	}
+	return ptr;
+}
+
+
+/* 容量 capacity 分の配置で、最上位の添字 [first, last) に属するポインタだけを書き込む */
+static void link_outer_range (void* block, const size_t sizes[], size_t dims, size_t elem_size, size_t capacity, size_t data_offset, size_t first, size_t last) {
+	char* data = (char*)block + data_offset;
+	void** level = block;
+	size_t count = capacity;  /* この階層のポインタ数 */
+	size_t per_outer = 1;     /* 最上位の添字1つあたりのポインタ数 */
+
+	for (size_t k = 0; k + 1 < dims; k++) {
+		void** next = level + count;
+		size_t stride = sizes[k + 1];
+		for (size_t e = first * per_outer; e < last * per_outer; e++) {
+			if (k + 2 < dims)
+				level[e] = next + (e * stride);
+			else
+				level[e] = data + (e * stride * elem_size);
+		}
+		level = next;
+		count *= stride;
+		per_outer *= stride;
+	}
+}
+
+
+/* 容量を old_capacity から new_capacity へ広げ、使用中の length 個分を新しい配置へ移す */
+static bool grow_reserved_nd_array (void** array, const size_t sizes[], size_t dims, size_t elem_size, size_t length, size_t old_capacity, size_t new_capacity) {
+	size_t old_ptrs, old_padding, old_total, new_ptrs, new_padding, new_total;
+	if (!calculate_size_with_outer(sizes, dims, old_capacity, elem_size, 0, &old_ptrs, &old_padding, &old_total) ||
+		!calculate_size_with_outer(sizes, dims, new_capacity, elem_size, 0, &new_ptrs, &new_padding, &new_total)) {
+		return false;
+	}
+
+	uintptr_t old_base = (uintptr_t)*array;
+	char* block = realloc(*array, new_ptrs + new_padding + (new_total * elem_size));
+	if (UNLIKELY(block == PTR_NULL)) {
+		errno = ENOMEM;
+		return false;
+	}
+
+	/* 各領域は後ろへしか移動しないので、データから順に上位の階層へ向かって移せば上書きされない */
+	size_t slab_bytes = (old_total / old_capacity) * elem_size;
+	memmove(block + new_ptrs + new_padding, block + old_ptrs + old_padding, length * slab_bytes);
+
+	for (size_t k = dims - 1; k-- > 0;) {
+		size_t per_outer = 1, before = 0;  /* 添字1つあたりのポインタ数と、上位の階層の添字1つあたりのポインタ数の合計 */
+		for (size_t j = 0; j < k; j++) {
+			before += per_outer;
+			per_outer *= sizes[j + 1];
+		}
+
+		void** old_level = (void**)(void*)block + (old_capacity * before);
+		void** new_level = (void**)(void*)block + (new_capacity * before);
+		memmove(new_level, old_level, length * per_outer * sizeof(void*));
+
+		/* この階層が指す先 (次の階層またはデータ) の移動量を一括で加算する */
+		uintptr_t old_target, new_target;
+		if (k + 2 < dims) {
+			old_target = old_base + ((old_capacity * (before + per_outer)) * sizeof(void*));
+			new_target = (uintptr_t)block + ((new_capacity * (before + per_outer)) * sizeof(void*));
+		} else {
+			old_target = old_base + old_ptrs + old_padding;
+			new_target = (uintptr_t)block + new_ptrs + new_padding;
+		}
+		rebase_pointer_table(new_level, length * per_outer, (const void*)old_target, (const void*)new_target);
+	}
+
+	*array = block;
+	return true;
+}
+
+
+void* alloc_nd_array_reserve (const size_t sizes[], size_t dims, size_t capacity, size_t elem_size) {
+	if (sizes == PTR_NULL || dims == 0 || capacity == 0 || sizes[0] > capacity) {
+		errno = EINVAL;
+		anda_errfunc = "alloc_nd_array_reserve";
+		return PTR_NULL;
+	}
+
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_size_with_outer(sizes, dims, capacity, elem_size, 0, &size_ptrs, &size_padding, &total_elements)) {
+		anda_errfunc = "alloc_nd_array_reserve";
+		return PTR_NULL;
+	}
+
+	void* block = malloc(size_ptrs + size_padding + (total_elements * elem_size));
+	if (UNLIKELY(block == PTR_NULL)) {
+		errno = ENOMEM;
+		anda_errfunc = "alloc_nd_array_reserve";
+		return PTR_NULL;
+	}
+
+	/* 未使用の容量のポインタは書き込まず、append_nd_array で使う時に書き込む */
+	if (dims > 1) link_outer_range(block, sizes, dims, elem_size, capacity, size_ptrs + size_padding, 0, sizes[0]);
+	return block;
+}
+
+
+void* append_nd_array (void** array, size_t sizes[], size_t dims, size_t* capacity, size_t elem_size) {
+	if (array == PTR_NULL || *array == PTR_NULL || sizes == PTR_NULL || dims == 0 ||
+		capacity == PTR_NULL || *capacity == 0 || sizes[0] > *capacity) {
+		errno = EINVAL;
+		anda_errfunc = "append_nd_array";
+		return PTR_NULL;
+	}
+
+	size_t length = sizes[0];
+	if (length == *capacity) {  /* 容量が尽きた時だけ2倍に広げる */
+		size_t new_capacity = (*capacity > SIZE_MAX / 2) ? SIZE_MAX : *capacity * 2;
+		if (new_capacity == length || !grow_reserved_nd_array(array, sizes, dims, elem_size, length, *capacity, new_capacity)) {
+			if (new_capacity == length) errno = EINVAL;
+			anda_errfunc = "append_nd_array";
+			return PTR_NULL;
+		}
+		*capacity = new_capacity;
+	}
+
+	sizes[0] = length + 1;
+	if (dims == 1) return (char*)*array + (length * elem_size);
+
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_size_with_outer(sizes, dims, *capacity, elem_size, 0, &size_ptrs, &size_padding, &total_elements)) {
+		sizes[0] = length;
+		anda_errfunc = "append_nd_array";
+		return PTR_NULL;
+	}
+	link_outer_range(*array, sizes, dims, elem_size, *capacity, size_ptrs + size_padding, length, length + 1);
+	return ((void**)*array)[length];
+}
+
+
 void free_nd_array (void* array) {
 	free(array);
 }
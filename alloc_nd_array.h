@@ -108,6 +108,105 @@ extern void* calloc_nd_array (const size_t sizes[], size_t dims, size_t elem_siz
 	calloc_nd_array((sizes), (dims), sizeof(elem_type))
 
 
+/*
+ * realloc_nd_array
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array or calloc_nd_array (NULL behaves like alloc_nd_array)
+ * @param old_sizes: sizes the array currently has (must have length equal to dims)
+ * @param new_sizes: sizes the array should have (must have length equal to dims)
+ * @param dims: number of array dimensions (must be the same as when the array was allocated)
+ * @param elem_size: size of each element in bytes (must be the same as when the array was allocated)
+ * @return: pointer to the resized multi-dimensional array or NULL on failure (in which case the original array is left untouched)
+ * @note: Every element whose indices are valid in both shapes keeps its value; new elements are uninitialized (use recalloc_nd_array if zero-initialization is desired). When every dimension grows, or every dimension shrinks, the block is resized with realloc() and the rows are moved inside it, so no second copy of the array is needed. Otherwise a new block is allocated and the rows are copied into it. The returned pointer may differ from array, and the old pointer must not be used afterwards.
+ */
+extern void* realloc_nd_array (void* array, const size_t old_sizes[], const size_t new_sizes[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * realloc_nd_array_t
+ */
+#define realloc_nd_array_t(array, old_sizes, new_sizes, dims, elem_type) \
+	realloc_nd_array((array), (old_sizes), (new_sizes), (dims), sizeof(elem_type))
+
+
+/*
+ * recalloc_nd_array
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array or calloc_nd_array (NULL behaves like calloc_nd_array)
+ * @param old_sizes: sizes the array currently has (must have length equal to dims)
+ * @param new_sizes: sizes the array should have (must have length equal to dims)
+ * @param dims: number of array dimensions (must be the same as when the array was allocated)
+ * @param elem_size: size of each element in bytes (must be the same as when the array was allocated)
+ * @return: pointer to the resized multi-dimensional array or NULL on failure (in which case the original array is left untouched)
+ * @note: Same as realloc_nd_array, except that new elements are set to zero.
+ */
+extern void* recalloc_nd_array (void* array, const size_t old_sizes[], const size_t new_sizes[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * recalloc_nd_array_t
+ */
+#define recalloc_nd_array_t(array, old_sizes, new_sizes, dims, elem_type) \
+	recalloc_nd_array((array), (old_sizes), (new_sizes), (dims), sizeof(elem_type))
+
+
+/*
+ * alloc_nd_array_reserve
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims); sizes[0] is the initial length of the outermost dimension and may be 0
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param capacity: number of outermost indices to reserve space for (must be at least sizes[0] and at least 1)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the multi-dimensional array or NULL on failure
+ * @note: The block has the layout of an array whose outermost size is capacity, but only the pointers for the first sizes[0] indices are written; the rest are filled in by append_nd_array. The contents of the elements are uninitialized. Release the array with free_nd_array.
+ */
+extern void* alloc_nd_array_reserve (const size_t sizes[], size_t dims, size_t capacity, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_nd_array_reserve_t
+ */
+#define alloc_nd_array_reserve_t(sizes, dims, capacity, elem_type) \
+	alloc_nd_array_reserve((sizes), (dims), (capacity), sizeof(elem_type))
+
+
+/*
+ * append_nd_array
+ * @param array: pointer to the variable holding the array allocated by alloc_nd_array_reserve (updated when the block moves)
+ * @param sizes: current sizes of the array (must have length equal to dims); sizes[0] is incremented on success
+ * @param dims: number of array dimensions (must be the same as when the array was allocated)
+ * @param capacity: pointer to the current capacity of the outermost dimension (updated when the array grows)
+ * @param elem_size: size of each element in bytes (must be the same as when the array was allocated)
+ * @return: pointer to the appended sub-array (e.g., a row of a 2D array, a 2D slab of a 3D array, an element of a 1D array) or NULL on failure (in which case the array is left untouched)
+ * @note: While there is spare capacity, only the pointers of the new index are written. When the capacity is exhausted it is doubled: the block is resized with realloc(), the used part of every pointer level and of the data is moved to its new position, and the pointers are adjusted by a fixed offset per level instead of being rebuilt. The contents of the appended elements are uninitialized. Existing pointers into the array are invalidated whenever the capacity grows.
+ */
+extern void* append_nd_array (void** array, size_t sizes[], size_t dims, size_t* capacity, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * append_nd_array_t
+ */
+#define append_nd_array_t(array, sizes, dims, capacity, elem_type) \
+	append_nd_array((array), (sizes), (dims), (capacity), sizeof(elem_type))
+
+
+/*
+ * rebase_nd_array
+ * @param block: pointer to the memory block that now holds the multi-dimensional array (e.g., after memcpy(), realloc(), mremap() or loading it from a file)
+ * @param old_base: address the block had when its pointer tables were last valid
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: block with its pointer tables valid for its current address, or NULL on failure
+ * @note: Every pointer in the tables points into the block itself, so the whole table is adjusted by the distance the block moved, using SIMD additions where available; this is much cheaper than rebuilding the tables from the shape. The data is not touched. The block must have been laid out by alloc_nd_array, calloc_nd_array or a function with the same layout (for arrays from alloc_nd_array_reserve, pass the capacity as sizes[0]). old_base is only used as a number and need not be a valid address anymore.
+ */
+extern void* rebase_nd_array (void* block, const void* old_base, const size_t sizes[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * rebase_nd_array_t
+ */
+#define rebase_nd_array_t(block, old_base, sizes, dims, elem_type) \
+	rebase_nd_array((block), (old_base), (sizes), (dims), sizeof(elem_type))
+
+
 /*
  * free_nd_array
  * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array or calloc_nd_array
@@ -0,0 +1,207 @@
+/*
+ * anda_bitarray.c -- implementation for bit-packed boolean multi-dimensional arrays
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+
+
+#include "anda_bitarray.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "cver_compat.h"
+
+
+/* 行単位の演算に使う SIMD 命令セット (64ビット環境のみ) */
+#if defined (__AVX2__) && (defined (__x86_64__) || defined (_M_X64))
+	#include <immintrin.h>
+	#define ANDA_BITS_AVX2
+#elif defined (__SSE2__) && (defined (__x86_64__) || defined (_M_X64))
+	#include <emmintrin.h>
+	#define ANDA_BITS_SSE2
+#elif defined (__aarch64__) && defined (__ARM_NEON)
+	#include <arm_neon.h>
+	#define ANDA_BITS_NEON
+#endif
+
+
+/* 最下層の次元をビット数からワード数に置き換えた形状で、uint64_t の通常の配列として確保する */
+static void* alloc_bits_impl (const size_t sizes[], size_t dims, bool zero_fill) {
+	if (sizes == PTR_NULL || dims == 0 || dims > SIZE_MAX / sizeof(size_t)) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	size_t* word_sizes = malloc(dims * sizeof(size_t));
+	if (UNLIKELY(word_sizes == PTR_NULL)) {
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+
+	memcpy(word_sizes, sizes, dims * sizeof(size_t));
+	word_sizes[dims - 1] = ANDA_BIT_WORDS(sizes[dims - 1]);  /* 0ビットの行は0ワードとなり、通常の配列と同様に拒否される */
+
+	/* 要素が uint64_t なので、各行はワード境界から始まる */
+	void* array = zero_fill ? calloc_nd_array(word_sizes, dims, sizeof(uint64_t)) : alloc_nd_array(word_sizes, dims, sizeof(uint64_t));
+	free(word_sizes);
+	return array;
+}
+
+
+void* alloc_bit_nd_array (const size_t sizes[], size_t dims) {
+	void* ptr = alloc_bits_impl(sizes, dims, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_bit_nd_array";
+	return ptr;
+}
+
+
+void* calloc_bit_nd_array (const size_t sizes[], size_t dims) {
+	void* ptr = alloc_bits_impl(sizes, dims, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_bit_nd_array";
+	return ptr;
+}
+
+
+static inline size_t popcount_word (uint64_t x) {
+#if defined (__GNUC__) || defined (__clang__)
+	return (size_t)__builtin_popcountll(x);
+#else
+	x = x - ((x >> 1) & 0x5555555555555555u);
+	x = (x & 0x3333333333333333u) + ((x >> 2) & 0x3333333333333333u);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Fu;
+	return (size_t)((x * 0x0101010101010101u) >> 56);
+#endif
+}
+
+
+size_t popcount_bit_row (const uint64_t* row, size_t nbits) {
+	if (row == PTR_NULL || nbits == 0) return 0;
+
+	size_t words = nbits / 64;  /* 端数のワードは最後にマスクして数える */
+	size_t count = 0;
+	size_t i = 0;
+
+#if defined (ANDA_BITS_AVX2)
+	/* 4ビットごとの表引きで各バイトのビット数を求め、sad で 64ビットごとに合計する */
+	const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+	                                        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i low_mask = _mm256_set1_epi8(0x0F);
+	__m256i total = _mm256_setzero_si256();
+	for (; i + 4 <= words; i += 4) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(const void*)(row + i));
+		__m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low_mask));
+		__m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask));
+		total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+	}
+	count += (size_t)_mm256_extract_epi64(total, 0) + (size_t)_mm256_extract_epi64(total, 1) +
+	         (size_t)_mm256_extract_epi64(total, 2) + (size_t)_mm256_extract_epi64(total, 3);
+#elif defined (ANDA_BITS_SSE2)
+	/* SWAR でバイトごとのビット数を求め、sad で 64ビットごとに合計する */
+	const __m128i m1 = _mm_set1_epi8(0x55);
+	const __m128i m2 = _mm_set1_epi8(0x33);
+	const __m128i m4 = _mm_set1_epi8(0x0F);
+	__m128i total = _mm_setzero_si128();
+	for (; i + 2 <= words; i += 2) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(const void*)(row + i));
+		v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v, 1), m1));
+		v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi16(v, 2), m2));
+		v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi16(v, 4)), m4);
+		total = _mm_add_epi64(total, _mm_sad_epu8(v, _mm_setzero_si128()));
+	}
+	count += (size_t)_mm_cvtsi128_si64(total) + (size_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(total, total));
+#elif defined (ANDA_BITS_NEON)
+	uint64x2_t total = vdupq_n_u64(0);
+	for (; i + 2 <= words; i += 2) {
+		uint8x16_t bytes = vcntq_u8(vreinterpretq_u8_u64(vld1q_u64(row + i)));
+		total = vpadalq_u32(total, vpaddlq_u16(vpaddlq_u8(bytes)));
+	}
+	count += (size_t)vaddvq_u64(total);
+#endif
+
+	for (; i < words; i++) {  /* 端数 (または SIMD が使えない環境での全体) */
+		count += popcount_word(row[i]);
+	}
+
+	if (nbits % 64 != 0) count += popcount_word(row[words] & (((uint64_t)1 << (nbits % 64)) - 1));
+	return count;
+}
+
+
+enum { BITS_AND, BITS_OR, BITS_XOR };
+
+
+/* op は呼び出し元で定数なので、インライン展開された各関数ではループ内の分岐が消える */
+static inline void combine_bit_rows (uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t nbits, int op) {
+	if (dst == PTR_NULL || a == PTR_NULL || b == PTR_NULL) return;
+
+	size_t words = ANDA_BIT_WORDS(nbits);
+	size_t i = 0;
+
+#if defined (ANDA_BITS_AVX2)
+	for (; i + 4 <= words; i += 4) {
+		__m256i va = _mm256_loadu_si256((const __m256i*)(const void*)(a + i));
+		__m256i vb = _mm256_loadu_si256((const __m256i*)(const void*)(b + i));
+		__m256i vr = (op == BITS_AND) ? _mm256_and_si256(va, vb) : (op == BITS_OR) ? _mm256_or_si256(va, vb) : _mm256_xor_si256(va, vb);
+		_mm256_storeu_si256((__m256i*)(void*)(dst + i), vr);
+	}
+#elif defined (ANDA_BITS_SSE2)
+	for (; i + 2 <= words; i += 2) {
+		__m128i va = _mm_loadu_si128((const __m128i*)(const void*)(a + i));
+		__m128i vb = _mm_loadu_si128((const __m128i*)(const void*)(b + i));
+		__m128i vr = (op == BITS_AND) ? _mm_and_si128(va, vb) : (op == BITS_OR) ? _mm_or_si128(va, vb) : _mm_xor_si128(va, vb);
+		_mm_storeu_si128((__m128i*)(void*)(dst + i), vr);
+	}
+#elif defined (ANDA_BITS_NEON)
+	for (; i + 2 <= words; i += 2) {
+		uint64x2_t va = vld1q_u64(a + i);
+		uint64x2_t vb = vld1q_u64(b + i);
+		uint64x2_t vr = (op == BITS_AND) ? vandq_u64(va, vb) : (op == BITS_OR) ? vorrq_u64(va, vb) : veorq_u64(va, vb);
+		vst1q_u64(dst + i, vr);
+	}
+#endif
+
+	for (; i < words; i++) {
+		dst[i] = (op == BITS_AND) ? (a[i] & b[i]) : (op == BITS_OR) ? (a[i] | b[i]) : (a[i] ^ b[i]);
+	}
+}
+
+
+void and_bit_rows (uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t nbits) {
+	combine_bit_rows(dst, a, b, nbits, BITS_AND);
+}
+
+
+void or_bit_rows (uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t nbits) {
+	combine_bit_rows(dst, a, b, nbits, BITS_OR);
+}
+
+
+void xor_bit_rows (uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t nbits) {
+	combine_bit_rows(dst, a, b, nbits, BITS_XOR);
+}
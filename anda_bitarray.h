@@ -0,0 +1,177 @@
+/*
+ * anda_bitarray.h -- interface for bit-packed boolean multi-dimensional arrays
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#pragma once
+
+#ifndef ANDA_BITARRAY_H
+#define ANDA_BITARRAY_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+
+/*
+ * A bit array stores one boolean per bit. Its last dimension is packed into rows of
+ * 64-bit words, and its pointer tables are those of a standard array of uint64_t, so
+ * a 3-D bit array is accessed as a uint64_t*** whose bottom level points to the word
+ * rows. Every row starts on a word boundary, and the bits past the end of a row fill
+ * the rest of its last word. The array is freed with a single free().
+ *
+ * Single bits are read and written with the accessors below, e.g.
+ * ANDA_BIT_TEST(a[i][j], k). Whole rows are combined and counted with the row kernels,
+ * which use SSE2, AVX2 or NEON when available.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+/* Number of 64-bit words that hold nbits bits */
+#define ANDA_BIT_WORDS(nbits) (((size_t)(nbits) + 63) / 64)
+
+/* Single-bit accessors for a word row (row is a uint64_t*, index is the bit index within the row) */
+#define ANDA_BIT_TEST(row, index)   ((((row)[(size_t)(index) >> 6]) >> ((size_t)(index) & 63)) & 1u)
+#define ANDA_BIT_SET(row, index)    ((row)[(size_t)(index) >> 6] |= ((uint64_t)1 << ((size_t)(index) & 63)))
+#define ANDA_BIT_CLEAR(row, index)  ((row)[(size_t)(index) >> 6] &= ~((uint64_t)1 << ((size_t)(index) & 63)))
+
+
+/*
+ * get_bit_nd_array
+ * @param row: pointer to a word row of a bit array (e.g., a[i][j] for a 3-D bit array)
+ * @param index: bit index within the row
+ * @return: value of the bit
+ */
+static inline bool get_bit_nd_array (const uint64_t* row, size_t index) {
+	return ((row[index >> 6] >> (index & 63)) & 1u) != 0;
+}
+
+
+/*
+ * set_bit_nd_array
+ * @param row: pointer to a word row of a bit array (e.g., a[i][j] for a 3-D bit array)
+ * @param index: bit index within the row
+ * @param value: value to store
+ * @note: This function does not branch on value.
+ */
+static inline void set_bit_nd_array (uint64_t* row, size_t index, bool value) {
+	uint64_t mask = (uint64_t)1 << (index & 63);
+	row[index >> 6] = (row[index >> 6] & ~mask) | (((uint64_t)0 - (uint64_t)value) & mask);
+}
+
+
+/*
+ * alloc_bit_nd_array
+ * @param sizes: array containing sizes for each dimension in bits (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @return: pointer to the multi-dimensional bit array or NULL on failure
+ * @note: After calling, cast the returned pointer to uint64_t* with one level of indirection per dimension (e.g., uint64_t** for a 2-D bit array) and address each row with the accessors. The allocated memory must be freed using free() when no longer needed. The returned memory is uninitialized.
+ */
+extern void* alloc_bit_nd_array (const size_t sizes[], size_t dims);
+
+
+/*
+ * calloc_bit_nd_array
+ * @param sizes: array containing sizes for each dimension in bits (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @return: pointer to the multi-dimensional bit array or NULL on failure
+ * @note: Same as alloc_bit_nd_array, except that every bit (including the unused bits of each last word) is cleared.
+ */
+extern void* calloc_bit_nd_array (const size_t sizes[], size_t dims);
+
+
+/*
+ * popcount_bit_row
+ * @param row: pointer to a word row of a bit array
+ * @param nbits: number of bits in the row
+ * @return: number of set bits among the first nbits bits
+ * @note: The unused bits of the last word are ignored.
+ */
+extern size_t popcount_bit_row (const uint64_t* row, size_t nbits);
+
+
+/*
+ * and_bit_rows
+ * @param dst: pointer to the word row that receives the result (may be the same as a or b)
+ * @param a: pointer to the first word row
+ * @param b: pointer to the second word row
+ * @param nbits: number of bits in the rows
+ * @note: Whole words are processed, so the unused bits of the last word are combined as well.
+ */
+extern void and_bit_rows (uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t nbits);
+
+
+/*
+ * or_bit_rows
+ * @param dst: pointer to the word row that receives the result (may be the same as a or b)
+ * @param a: pointer to the first word row
+ * @param b: pointer to the second word row
+ * @param nbits: number of bits in the rows
+ * @note: Whole words are processed, so the unused bits of the last word are combined as well.
+ */
+extern void or_bit_rows (uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t nbits);
+
+
+/*
+ * xor_bit_rows
+ * @param dst: pointer to the word row that receives the result (may be the same as a or b)
+ * @param a: pointer to the first word row
+ * @param b: pointer to the second word row
+ * @param nbits: number of bits in the rows
+ * @note: Whole words are processed, so the unused bits of the last word are combined as well.
+ */
+extern void xor_bit_rows (uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t nbits);
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
@@ -0,0 +1,228 @@
+/*
+ * anda_bounds.c -- implementation of multi-dimensional arrays whose indices do not start
+ *                  at zero
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+
+#include "anda_bounds.h"
+#include "anda_llapi.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include "cver_compat.h"
+
+
+/* 最上位のポインタテーブル (1次元ならデータ) の1要素のバイト数 */
+static inline size_t outer_unit (size_t dims, size_t elem_size) {
+	return (dims > 1) ? sizeof(void*) : elem_size;
+}
+
+
+/*
+ * 通常の配置で組み立て済みのブロックのポインタを、各次元の添字 i が i + offsets[d] の位置を
+ * 指すようにずらし、添字0に当たる位置を返す (オフセットは符号なしの剰余演算で加算する)
+ */
+static void* apply_index_offsets (void* block, const size_t extents[], size_t dims, size_t elem_size, size_t data_offset, const ptrdiff_t offsets[]) {
+	char* level = block;
+	size_t count = 1;
+	for (size_t k = 0; k + 1 < dims; k++) {
+		count *= extents[k];
+		char* next = (k + 2 < dims) ? level + (count * sizeof(void*)) : (char*)block + data_offset;
+		size_t unit = (k + 2 < dims) ? sizeof(void*) : elem_size;
+		uintptr_t shift = (uintptr_t)offsets[k + 1] * (uintptr_t)unit;
+		rebase_pointer_table((void**)(void*)level, count, next, (const void*)((uintptr_t)next + shift));
+		level = next;
+	}
+
+	return (void*)((uintptr_t)block + ((uintptr_t)offsets[0] * (uintptr_t)outer_unit(dims, elem_size)));
+}
+
+
+/* 添字のずれを組み込んだ配列を確保する (extents は各次元の要素数) */
+static void* alloc_offset_nd_array (const size_t extents[], const ptrdiff_t offsets[], size_t dims, size_t elem_size, bool zero_fill) {
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_nd_array_size(extents, dims, elem_size, &size_ptrs, &size_padding, &total_elements)) return PTR_NULL;
+
+	void* block = zero_fill ? calloc_nd_array(extents, dims, elem_size) : alloc_nd_array(extents, dims, elem_size);
+	if (block == PTR_NULL) return PTR_NULL;
+
+	return apply_index_offsets(block, extents, dims, elem_size, size_ptrs + size_padding, offsets);
+}
+
+
+/* 添字0に当たる位置から確保したブロックの先頭を求める */
+static void* block_of (void* array, ptrdiff_t offset0, size_t dims, size_t elem_size) {
+	return (void*)((uintptr_t)array - ((uintptr_t)offset0 * (uintptr_t)outer_unit(dims, elem_size)));
+}
+
+
+static void* alloc_halo_impl (const size_t sizes[], const size_t halo_widths[], size_t dims, size_t elem_size, bool zero_fill) {
+	if (sizes == PTR_NULL || halo_widths == PTR_NULL || dims == 0 || dims > SIZE_MAX / sizeof(size_t)) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	size_t* extents = malloc(dims * sizeof(size_t));
+	ptrdiff_t* offsets = malloc(dims * sizeof(ptrdiff_t));
+	if (UNLIKELY(extents == PTR_NULL || offsets == PTR_NULL)) {
+		free(extents);
+		free(offsets);
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+
+	bool valid = true;
+	for (size_t d = 0; d < dims; d++) {
+		if (halo_widths[d] > (SIZE_MAX - sizes[d]) / 2 || halo_widths[d] > (size_t)PTRDIFF_MAX) {
+			valid = false;
+			break;
+		}
+		extents[d] = sizes[d] + (2 * halo_widths[d]);
+		offsets[d] = (ptrdiff_t)halo_widths[d];  /* 添字 -halo が確保した領域の先頭に当たる */
+	}
+
+	void* array = PTR_NULL;
+	if (valid)
+		array = alloc_offset_nd_array(extents, offsets, dims, elem_size, zero_fill);
+	else
+		errno = EINVAL;
+
+	free(extents);
+	free(offsets);
+	return array;
+}
+
+
+void* alloc_nd_array_halo (const size_t sizes[], const size_t halo_widths[], size_t dims, size_t elem_size) {
+	void* ptr = alloc_halo_impl(sizes, halo_widths, dims, elem_size, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_nd_array_halo";
+	return ptr;
+}
+
+
+void* calloc_nd_array_halo (const size_t sizes[], const size_t halo_widths[], size_t dims, size_t elem_size) {
+	void* ptr = alloc_halo_impl(sizes, halo_widths, dims, elem_size, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_nd_array_halo";
+	return ptr;
+}
+
+
+void free_nd_array_halo (void* array, const size_t halo_widths[], size_t dims, size_t elem_size) {
+	if (array == PTR_NULL) return;
+
+	if (UNLIKELY(halo_widths == PTR_NULL || dims == 0)) {
+		errno = EINVAL;
+		anda_errfunc = "free_nd_array_halo";
+		return;
+	}
+
+	free(block_of(array, (ptrdiff_t)halo_widths[0], dims, elem_size));
+}
+
+
+static void* alloc_bounds_impl (const ptrdiff_t lower[], const ptrdiff_t upper[], size_t dims, size_t elem_size, bool zero_fill) {
+	if (lower == PTR_NULL || upper == PTR_NULL || dims == 0 || dims > SIZE_MAX / sizeof(size_t)) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	size_t* extents = malloc(dims * sizeof(size_t));
+	ptrdiff_t* offsets = malloc(dims * sizeof(ptrdiff_t));
+	if (UNLIKELY(extents == PTR_NULL || offsets == PTR_NULL)) {
+		free(extents);
+		free(offsets);
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+
+	bool valid = true;
+	for (size_t d = 0; d < dims; d++) {
+		/* 範囲の差は符号なしで求める (upper - lower は ptrdiff_t では溢れることがある) */
+		if (upper[d] < lower[d] || lower[d] == PTRDIFF_MIN) {
+			valid = false;
+			break;
+		}
+		size_t span = (size_t)upper[d] - (size_t)lower[d];
+		if (span == SIZE_MAX) {
+			valid = false;
+			break;
+		}
+		extents[d] = span + 1;
+		offsets[d] = -lower[d];  /* 添字 lower が確保した領域の先頭に当たる */
+	}
+
+	void* array = PTR_NULL;
+	if (valid)
+		array = alloc_offset_nd_array(extents, offsets, dims, elem_size, zero_fill);
+	else
+		errno = EINVAL;
+
+	free(extents);
+	free(offsets);
+	return array;
+}
+
+
+void* alloc_nd_array_bounds (const ptrdiff_t lower[], const ptrdiff_t upper[], size_t dims, size_t elem_size) {
+	void* ptr = alloc_bounds_impl(lower, upper, dims, elem_size, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_nd_array_bounds";
+	return ptr;
+}
+
+
+void* calloc_nd_array_bounds (const ptrdiff_t lower[], const ptrdiff_t upper[], size_t dims, size_t elem_size) {
+	void* ptr = alloc_bounds_impl(lower, upper, dims, elem_size, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_nd_array_bounds";
+	return ptr;
+}
+
+
+void* get_nd_array_bounds_base (void* array, const ptrdiff_t lower[], size_t dims, size_t elem_size) {
+	if (UNLIKELY(array == PTR_NULL || lower == PTR_NULL || dims == 0)) {
+		errno = EINVAL;
+		anda_errfunc = "get_nd_array_bounds_base";
+		return PTR_NULL;
+	}
+
+	return block_of(array, -lower[0], dims, elem_size);
+}
+
+
+void free_nd_array_bounds (void* array, const ptrdiff_t lower[], size_t dims, size_t elem_size) {
+	if (array == PTR_NULL) return;
+
+	if (UNLIKELY(lower == PTR_NULL || dims == 0)) {
+		errno = EINVAL;
+		anda_errfunc = "free_nd_array_bounds";
+		return;
+	}
+
+	free(block_of(array, -lower[0], dims, elem_size));
+}
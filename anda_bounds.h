@@ -0,0 +1,212 @@
+/*
+ * anda_bounds.h -- interface for multi-dimensional arrays whose indices do not start
+ *                  at zero
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#pragma once
+
+#ifndef ANDA_BOUNDS_H
+#define ANDA_BOUNDS_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * The arrays in this header are allocated like those of alloc_nd_array, but the
+ * offsets of their index ranges are built into the pointer tables, so they are
+ * indexed directly with their own bounds (e.g., a[-1][j] for a halo cell, or a[k][-k]
+ * for an array declared as a(0:n, -k:k) in Fortran) with no index arithmetic in the
+ * inner loops.
+ *
+ * Because the returned pointer does not point to the start of the block, these
+ * arrays must be released with their dedicated free function, never with free() or
+ * free_nd_array.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+/*
+ * alloc_nd_array_halo
+ * @param sizes: array containing the sizes of the interior for each dimension (must have length equal to dims)
+ * @param halo_widths: array containing the width of the halo on each side for each dimension (must have length equal to dims; 0 for no halo)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the multi-dimensional array or NULL on failure
+ * @note: The valid indices of dimension d run from -halo_widths[d] to sizes[d] + halo_widths[d] - 1, so the interior starts at index 0. The array occupies one block holding (sizes[d] + 2 * halo_widths[d]) elements per dimension. The memory is uninitialized. Release the array with free_nd_array_halo.
+ */
+extern void* alloc_nd_array_halo (const size_t sizes[], const size_t halo_widths[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_nd_array_halo_t
+ */
+#define alloc_nd_array_halo_t(sizes, halo_widths, dims, elem_type) \
+	alloc_nd_array_halo((sizes), (halo_widths), (dims), sizeof(elem_type))
+
+
+/*
+ * calloc_nd_array_halo
+ * @param sizes: array containing the sizes of the interior for each dimension (must have length equal to dims)
+ * @param halo_widths: array containing the width of the halo on each side for each dimension (must have length equal to dims; 0 for no halo)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the multi-dimensional array or NULL on failure
+ * @note: Same as alloc_nd_array_halo, except that every element, including the halo, is set to zero.
+ */
+extern void* calloc_nd_array_halo (const size_t sizes[], const size_t halo_widths[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_nd_array_halo_t
+ */
+#define calloc_nd_array_halo_t(sizes, halo_widths, dims, elem_type) \
+	calloc_nd_array_halo((sizes), (halo_widths), (dims), sizeof(elem_type))
+
+
+/*
+ * free_nd_array_halo
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_halo or calloc_nd_array_halo (NULL is ignored)
+ * @param halo_widths: the halo widths the array was allocated with
+ * @param dims: number of array dimensions (must be the same as when the array was allocated)
+ * @param elem_size: size of each element in bytes (must be the same as when the array was allocated)
+ * @note: this function frees the whole block, halo included
+ */
+extern void free_nd_array_halo (void* array, const size_t halo_widths[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * free_nd_array_halo_t
+ */
+#define free_nd_array_halo_t(array, halo_widths, dims, elem_type) \
+	free_nd_array_halo((array), (halo_widths), (dims), sizeof(elem_type))
+
+
+/*
+ * alloc_nd_array_bounds
+ * @param lower: array containing the lowest valid index for each dimension (must have length equal to dims; may be negative)
+ * @param upper: array containing the highest valid index for each dimension (must have length equal to dims; inclusive, at least lower[d])
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the multi-dimensional array or NULL on failure
+ * @note: The valid indices of dimension d run from lower[d] to upper[d], and the array occupies one block holding (upper[d] - lower[d] + 1) elements per dimension; the range is computed without signed overflow. The memory is uninitialized. Release the array with free_nd_array_bounds. When a lower bound is positive, the returned pointer (or an intermediate one) lies before the block it indexes; this works on all flat-memory platforms, but it is outside what ISO C guarantees, and tools such as pointer-overflow sanitizers may report it.
+ */
+extern void* alloc_nd_array_bounds (const ptrdiff_t lower[], const ptrdiff_t upper[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_nd_array_bounds_t
+ */
+#define alloc_nd_array_bounds_t(lower, upper, dims, elem_type) \
+	alloc_nd_array_bounds((lower), (upper), (dims), sizeof(elem_type))
+
+
+/*
+ * calloc_nd_array_bounds
+ * @param lower: array containing the lowest valid index for each dimension (must have length equal to dims; may be negative)
+ * @param upper: array containing the highest valid index for each dimension (must have length equal to dims; inclusive, at least lower[d])
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the multi-dimensional array or NULL on failure
+ * @note: Same as alloc_nd_array_bounds, except that every element is set to zero.
+ */
+extern void* calloc_nd_array_bounds (const ptrdiff_t lower[], const ptrdiff_t upper[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_nd_array_bounds_t
+ */
+#define calloc_nd_array_bounds_t(lower, upper, dims, elem_type) \
+	calloc_nd_array_bounds((lower), (upper), (dims), sizeof(elem_type))
+
+
+/*
+ * get_nd_array_bounds_base
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_bounds or calloc_nd_array_bounds
+ * @param lower: the lower bounds the array was allocated with
+ * @param dims: number of array dimensions (must be the same as when the array was allocated)
+ * @param elem_size: size of each element in bytes (must be the same as when the array was allocated)
+ * @return: pointer to the start of the block that holds the array, or NULL on failure
+ * @note: The block has the layout of an alloc_nd_array array of (upper[d] - lower[d] + 1) elements per dimension, except that its pointers carry the index offsets, so it can be copied or moved as a whole (e.g., with memcpy() followed by rebase_nd_array on the block).
+ */
+extern void* get_nd_array_bounds_base (void* array, const ptrdiff_t lower[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * get_nd_array_bounds_base_t
+ */
+#define get_nd_array_bounds_base_t(array, lower, dims, elem_type) \
+	get_nd_array_bounds_base((array), (lower), (dims), sizeof(elem_type))
+
+
+/*
+ * free_nd_array_bounds
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_bounds or calloc_nd_array_bounds (NULL is ignored)
+ * @param lower: the lower bounds the array was allocated with
+ * @param dims: number of array dimensions (must be the same as when the array was allocated)
+ * @param elem_size: size of each element in bytes (must be the same as when the array was allocated)
+ * @note: this function frees the whole block that holds the array
+ */
+extern void free_nd_array_bounds (void* array, const ptrdiff_t lower[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * free_nd_array_bounds_t
+ */
+#define free_nd_array_bounds_t(array, lower, dims, elem_type) \
+	free_nd_array_bounds((array), (lower), (dims), sizeof(elem_type))
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
@@ -0,0 +1,208 @@
+/*
+ * anda_copy.c -- implementation of whole-block copies of multi-dimensional arrays
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#include "anda_copy.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined (__unix__) || defined (__APPLE__)
+	#include <pthread.h>
+	#define ANDA_COPY_THREADS
+#endif
+
+#if defined (__SSE2__) || defined (_M_X64)
+	#include <emmintrin.h>
+	#define ANDA_COPY_SSE2
+#endif
+
+#include "cver_compat.h"
+
+
+#define COPY_MAX_THREADS 64                /* 分割するスレッド数の上限 */
+#define COPY_MIN_CHUNK ((size_t)1 << 20)   /* 1スレッドに任せる最小バイト数 (これより小さい分割は起動コストで損をする) */
+#define COPY_NT_MIN_SIZE 256               /* これより短いコピーは非テンポラルストアを使わない */
+
+
+/* 範囲をコピーする (非テンポラル指定時はキャッシュを経由しないストアを使う) */
+static void copy_range (char* dst, const char* src, size_t size, bool nontemporal) {
+#ifdef ANDA_COPY_SSE2
+	if (nontemporal && size >= COPY_NT_MIN_SIZE) {
+		/* ストリーミングストアは16バイト境界が必要なので、先頭の端数は通常のコピーで揃える */
+		size_t head = (16 - ((uintptr_t)dst & 15)) & 15;
+		memcpy(dst, src, head);
+		dst += head;
+		src += head;
+		size -= head;
+
+		size_t i = 0;
+		for (; i + 64 <= size; i += 64) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(const void*)(src + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(const void*)(src + i + 16));
+			__m128i c = _mm_loadu_si128((const __m128i*)(const void*)(src + i + 32));
+			__m128i d = _mm_loadu_si128((const __m128i*)(const void*)(src + i + 48));
+			_mm_stream_si128((__m128i*)(void*)(dst + i), a);
+			_mm_stream_si128((__m128i*)(void*)(dst + i + 16), b);
+			_mm_stream_si128((__m128i*)(void*)(dst + i + 32), c);
+			_mm_stream_si128((__m128i*)(void*)(dst + i + 48), d);
+		}
+		memcpy(dst + i, src + i, size - i);
+		_mm_sfence();  /* 以降の通常のロード・ストアより前にストリーミングストアを完了させる */
+		return;
+	}
+#else
+	(void)nontemporal;
+#endif
+
+	memcpy(dst, src, size);
+}
+
+
+#ifdef ANDA_COPY_THREADS
+typedef struct {
+	char* dst;
+	const char* src;
+	size_t size;
+	bool nontemporal;
+} copyTask;
+
+
+static void* copy_task (void* arg) {
+	copyTask* task = arg;
+	copy_range(task->dst, task->src, task->size, task->nontemporal);
+	return PTR_NULL;
+}
+#endif
+
+
+/* 必要に応じて複数スレッドに分割してコピーする */
+static void copy_block (void* dst, const void* src, size_t size, unsigned int flags, size_t nthreads) {
+	bool nontemporal = (flags & ANDA_COPY_NONTEMPORAL) != 0;
+
+#ifdef ANDA_COPY_THREADS
+	if (nthreads > size / COPY_MIN_CHUNK) nthreads = size / COPY_MIN_CHUNK;
+	if (nthreads > COPY_MAX_THREADS) nthreads = COPY_MAX_THREADS;
+
+	if (nthreads > 1) {
+		copyTask tasks[COPY_MAX_THREADS];
+		pthread_t threads[COPY_MAX_THREADS];
+		bool started[COPY_MAX_THREADS];
+
+		/* 分割境界はキャッシュライン単位に揃える (スレッド間で同じラインに書き込まないため) */
+		size_t chunk = anda_align_up((size + nthreads - 1) / nthreads, 64);
+		for (size_t i = 0; i < nthreads; i++) {
+			size_t offset = (i * chunk < size) ? i * chunk : size;
+			tasks[i].dst = (char*)dst + offset;
+			tasks[i].src = (const char*)src + offset;
+			tasks[i].size = (size - offset < chunk) ? size - offset : chunk;
+			tasks[i].nontemporal = nontemporal;
+		}
+
+		for (size_t i = 1; i < nthreads; i++) {
+			started[i] = (pthread_create(&threads[i], PTR_NULL, copy_task, &tasks[i]) == 0);
+			if (!started[i]) copy_task(&tasks[i]);  /* 起動できなければ呼び出し元で肩代わりする */
+		}
+		copy_task(&tasks[0]);
+		for (size_t i = 1; i < nthreads; i++) {
+			if (started[i]) pthread_join(threads[i], PTR_NULL);
+		}
+		return;
+	}
+#else
+	(void)nthreads;
+#endif
+
+	copy_range(dst, src, size, nontemporal);
+}
+
+
+void* clone_nd_array_ex (const void* array, const size_t sizes[], size_t dims, size_t elem_size, unsigned int flags, size_t nthreads) {
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_nd_array_size(sizes, dims, elem_size, &size_ptrs, &size_padding, &total_elements)) {
+		anda_errfunc = "clone_nd_array_ex";
+		return PTR_NULL;
+	}
+
+	if (array == PTR_NULL) {
+		errno = EINVAL;
+		anda_errfunc = "clone_nd_array_ex";
+		return PTR_NULL;
+	}
+
+	size_t data_offset = size_ptrs + size_padding;
+	char* block = malloc(data_offset + (total_elements * elem_size));
+	if (UNLIKELY(block == PTR_NULL)) {
+		errno = ENOMEM;
+		anda_errfunc = "clone_nd_array_ex";
+		return PTR_NULL;
+	}
+
+	/* ポインタテーブルは直後に書き換えるのでキャッシュに載せたままコピーし、データだけ指定の方法でコピーする */
+	memcpy(block, array, data_offset);
+	copy_block(block + data_offset, (const char*)array + data_offset, total_elements * elem_size, flags, nthreads);
+
+	return rebase_nd_array(block, array, sizes, dims, elem_size);
+}
+
+
+void* clone_nd_array (const void* array, const size_t sizes[], size_t dims, size_t elem_size) {
+	void* ptr = clone_nd_array_ex(array, sizes, dims, elem_size, 0, 1);
+	if (ptr == PTR_NULL) anda_errfunc = "clone_nd_array";
+	return ptr;
+}
+
+
+bool copy_nd_array_into_ex (void* dst, const void* src, const size_t sizes[], size_t dims, size_t elem_size, unsigned int flags, size_t nthreads) {
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_nd_array_size(sizes, dims, elem_size, &size_ptrs, &size_padding, &total_elements)) {
+		anda_errfunc = "copy_nd_array_into_ex";
+		return false;
+	}
+
+	if (dst == PTR_NULL || src == PTR_NULL) {
+		errno = EINVAL;
+		anda_errfunc = "copy_nd_array_into_ex";
+		return false;
+	}
+
+	size_t data_offset = size_ptrs + size_padding;
+	copy_block((char*)dst + data_offset, (const char*)src + data_offset, total_elements * elem_size, flags, nthreads);
+	return true;
+}
+
+
+bool copy_nd_array_into (void* dst, const void* src, const size_t sizes[], size_t dims, size_t elem_size) {
+	if (!copy_nd_array_into_ex(dst, src, sizes, dims, elem_size, 0, 1)) {
+		anda_errfunc = "copy_nd_array_into";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,164 @@
+/*
+ * anda_copy.h -- interface for copying multi-dimensional arrays as whole blocks
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#pragma once
+
+#ifndef ANDA_COPY_H
+#define ANDA_COPY_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * An array allocated by alloc_nd_array is one contiguous block whose pointer tables
+ * point into the block itself. The functions in this header therefore copy the block
+ * with a single bulk copy and then fix up the pointer tables with rebase_nd_array,
+ * instead of walking the array element by element.
+ *
+ * The functions assume the standard layout of alloc_nd_array and calloc_nd_array;
+ * arrays with manual padding cannot be passed to them.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+/* Flags for clone_nd_array_ex and copy_nd_array_into_ex */
+#define ANDA_COPY_NONTEMPORAL  0x01u  /* bypass the cache with streaming stores (x86 only; ignored elsewhere) */
+
+
+/*
+ * clone_nd_array
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array or calloc_nd_array
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the new multi-dimensional array or NULL on failure
+ * @note: The new array is an independent deep copy. It must be freed using free() (or free_nd_array) when no longer needed.
+ */
+extern void* clone_nd_array (const void* array, const size_t sizes[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * clone_nd_array_t
+ */
+#define clone_nd_array_t(array, sizes, dims, elem_type) \
+	clone_nd_array((array), (sizes), (dims), sizeof(elem_type))
+
+
+/*
+ * clone_nd_array_ex
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array or calloc_nd_array
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param flags: combination of ANDA_COPY_* flags
+ * @param nthreads: number of threads that share the copy (0 or 1 copies on the calling thread)
+ * @return: pointer to the new multi-dimensional array or NULL on failure
+ * @note: Non-temporal stores help when the copy is much larger than the last-level cache and will not be read again soon. Splitting the copy across threads only pays off for copies of many megabytes. If a thread cannot be started, its share is copied on the calling thread.
+ */
+extern void* clone_nd_array_ex (const void* array, const size_t sizes[], size_t dims, size_t elem_size, unsigned int flags, size_t nthreads);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * clone_nd_array_ex_t
+ */
+#define clone_nd_array_ex_t(array, sizes, dims, elem_type, flags, nthreads) \
+	clone_nd_array_ex((array), (sizes), (dims), sizeof(elem_type), (flags), (nthreads))
+
+
+/*
+ * copy_nd_array_into
+ * @param dst: pointer to the multi-dimensional array that receives the elements
+ * @param src: pointer to the multi-dimensional array to copy from
+ * @param sizes: sizes shared by both arrays (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: true if the elements were copied, false if an error occurred
+ * @note: Both arrays must have the same shape. Only the data region is copied, because the pointer tables of dst are already valid. The arrays must not overlap.
+ */
+extern bool copy_nd_array_into (void* dst, const void* src, const size_t sizes[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * copy_nd_array_into_t
+ */
+#define copy_nd_array_into_t(dst, src, sizes, dims, elem_type) \
+	copy_nd_array_into((dst), (src), (sizes), (dims), sizeof(elem_type))
+
+
+/*
+ * copy_nd_array_into_ex
+ * @param dst: pointer to the multi-dimensional array that receives the elements
+ * @param src: pointer to the multi-dimensional array to copy from
+ * @param sizes: sizes shared by both arrays (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param flags: combination of ANDA_COPY_* flags
+ * @param nthreads: number of threads that share the copy (0 or 1 copies on the calling thread)
+ * @return: true if the elements were copied, false if an error occurred
+ * @note: Same as copy_nd_array_into, with the copy options of clone_nd_array_ex.
+ */
+extern bool copy_nd_array_into_ex (void* dst, const void* src, const size_t sizes[], size_t dims, size_t elem_size, unsigned int flags, size_t nthreads);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * copy_nd_array_into_ex_t
+ */
+#define copy_nd_array_into_ex_t(dst, src, sizes, dims, elem_type, flags, nthreads) \
+	copy_nd_array_into_ex((dst), (src), (sizes), (dims), sizeof(elem_type), (flags), (nthreads))
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
@@ -0,0 +1,224 @@
+/*
+ * anda_layout.c -- implementation of alternative memory layouts of multi-dimensional
+ *                  arrays
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+
+#include "anda_layout.h"
+#include "anda_llapi.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include "cver_compat.h"
+
+
+#define ORDERED_ARRAY_ALIGN 16  /* 記述子の後ろに置く配列の先頭を揃える境界 (ポインタと一般的な要素型の両方を満たす) */
+
+
+/* 最大公約数 (スラブの境界を揃える単位の計算に使用) */
+static size_t gcd_size (size_t a, size_t b) {
+	while (b != 0) {
+		size_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+
+static void* alloc_interleaved_impl (const size_t sizes[], size_t dims, size_t elem_size, bool zero_fill) {
+	if (sizes == PTR_NULL || dims == 0) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	/* 2次元以下ではスラブごとのポインタテーブルが存在しないので通常の配置と同じになる */
+	if (dims <= 2) return zero_fill ? calloc_nd_array(sizes, dims, elem_size) : alloc_nd_array(sizes, dims, elem_size);
+
+	size_t sub_ptrs, sub_padding, sub_total;
+	if (!calculate_nd_array_size(sizes + 1, dims - 1, elem_size, &sub_ptrs, &sub_padding, &sub_total)) return PTR_NULL;
+	if (sizes[0] == 0 || sizes[0] > (SIZE_MAX / sizeof(void*))) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	/*
+	 * 各スラブの先頭はポインタのために sizeof(void*) の倍数に、データ部分は要素サイズの倍数になるように
+	 * 両者の最小公倍数に揃える (スラブ内のパディングはスラブ先頭からの要素サイズの倍数で計算されている)
+	 */
+	size_t slab_align = sizeof(void*);
+	if (elem_size > sizeof(void*)) {
+		size_t g = gcd_size(elem_size, sizeof(void*));
+		if (elem_size / g > SIZE_MAX / sizeof(void*)) {
+			errno = EINVAL;
+			return PTR_NULL;
+		}
+		slab_align = (elem_size / g) * sizeof(void*);
+	}
+
+	size_t top_size = anda_align_up(sizes[0] * sizeof(void*), slab_align);
+	size_t stride = anda_align_up(sub_ptrs + sub_padding + (sub_total * elem_size), slab_align);
+	if (top_size == 0 || stride == 0 || stride > (SIZE_MAX - top_size) / sizes[0]) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	size_t size = top_size + (sizes[0] * stride);
+	char* block = zero_fill ? calloc(1, size) : malloc(size);
+	if (UNLIKELY(block == PTR_NULL)) {
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+
+	/* スラブごとに、先頭にポインタテーブル、続けてデータを持つ (dims - 1) 次元配列を組み立てる */
+	void** top = (void**)(void*)block;
+	for (size_t i = 0; i < sizes[0]; i++) {
+		char* slab = block + top_size + (i * stride);
+		top[i] = initialize_nd_array(slab, sizes + 1, dims - 1, elem_size, sub_ptrs, sub_padding, sub_total);
+	}
+
+	return block;
+}
+
+
+void* alloc_nd_array_interleaved (const size_t sizes[], size_t dims, size_t elem_size) {
+	void* ptr = alloc_interleaved_impl(sizes, dims, elem_size, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_nd_array_interleaved";
+	return ptr;
+}
+
+
+void* calloc_nd_array_interleaved (const size_t sizes[], size_t dims, size_t elem_size) {
+	void* ptr = alloc_interleaved_impl(sizes, dims, elem_size, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_nd_array_interleaved";
+	return ptr;
+}
+
+
+/* order を形状の読み方に変換してサイズを計算する (列優先の配列は形状を逆順にした行優先の配列と同じ配置になる) */
+static bool ordered_layout (const size_t sizes[], size_t dims, size_t elem_size, unsigned int order, unsigned int* shape_flags, size_t* size_ptrs, size_t* size_padding, size_t* total_elements) {
+	if (order != ANDA_ORDER_ROW_MAJOR && order != ANDA_ORDER_COLUMN_MAJOR) {
+		errno = EINVAL;
+		return false;
+	}
+	*shape_flags = (order == ANDA_ORDER_COLUMN_MAJOR) ? ANDA_SHAPE_REVERSED : 0;
+	return calculate_nd_array_size_ex(sizes, dims, elem_size, *shape_flags, size_ptrs, size_padding, total_elements);
+}
+
+
+static void* alloc_order_impl (const size_t sizes[], size_t dims, size_t elem_size, unsigned int order, bool zero_fill) {
+	if (order == ANDA_ORDER_ROW_MAJOR) return zero_fill ? calloc_nd_array(sizes, dims, elem_size) : alloc_nd_array(sizes, dims, elem_size);
+
+	unsigned int shape_flags;
+	size_t size_ptrs, size_padding, total_elements;
+	if (!ordered_layout(sizes, dims, elem_size, order, &shape_flags, &size_ptrs, &size_padding, &total_elements)) return PTR_NULL;
+
+	size_t size = size_ptrs + size_padding + (total_elements * elem_size);
+	char* block = zero_fill ? calloc(1, size) : malloc(size);
+	if (UNLIKELY(block == PTR_NULL)) {
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+	return initialize_nd_array_ex(block, sizes, dims, elem_size, shape_flags, size_ptrs, size_padding, total_elements);
+}
+
+
+void* alloc_nd_array_order (const size_t sizes[], size_t dims, size_t elem_size, unsigned int order) {
+	void* ptr = alloc_order_impl(sizes, dims, elem_size, order, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_nd_array_order";
+	return ptr;
+}
+
+
+void* calloc_nd_array_order (const size_t sizes[], size_t dims, size_t elem_size, unsigned int order) {
+	void* ptr = alloc_order_impl(sizes, dims, elem_size, order, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_nd_array_order";
+	return ptr;
+}
+
+
+void* get_nd_array_data (void* array, const size_t sizes[], size_t dims, size_t elem_size, unsigned int order) {
+	unsigned int shape_flags;
+	size_t size_ptrs, size_padding, total_elements;
+	if (array == PTR_NULL || !ordered_layout(sizes, dims, elem_size, order, &shape_flags, &size_ptrs, &size_padding, &total_elements)) {
+		if (array == PTR_NULL) errno = EINVAL;
+		anda_errfunc = "get_nd_array_data";
+		return PTR_NULL;
+	}
+	return (char*)array + size_ptrs + size_padding;
+}
+
+
+/* 記述子と配列を1つのブロックに置く ([記述子][各次元のサイズ][パディング][配列]) */
+static ndArrayOrdered* alloc_ordered_impl (const size_t sizes[], size_t dims, size_t elem_size, unsigned int order, bool zero_fill) {
+	unsigned int shape_flags;
+	size_t size_ptrs, size_padding, total_elements;
+	if (!ordered_layout(sizes, dims, elem_size, order, &shape_flags, &size_ptrs, &size_padding, &total_elements)) return PTR_NULL;
+
+	size_t size_array = size_ptrs + size_padding + (total_elements * elem_size);
+	size_t offset = anda_align_up(sizeof(ndArrayOrdered) + dims * sizeof(size_t), ORDERED_ARRAY_ALIGN);  /* dims は ordered_layout で検証済み */
+	if (offset == 0 || size_array > SIZE_MAX - offset) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	char* block = zero_fill ? calloc(1, offset + size_array) : malloc(offset + size_array);
+	if (UNLIKELY(block == PTR_NULL)) {
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+
+	ndArrayOrdered* ordered = (ndArrayOrdered*)(void*)block;
+	char* array = block + offset;
+	ordered->array = initialize_nd_array_ex(array, sizes, dims, elem_size, shape_flags, size_ptrs, size_padding, total_elements);
+	ordered->data = array + size_ptrs + size_padding;
+	ordered->dims = dims;
+	ordered->elem_size = elem_size;
+	ordered->order = order;
+	ordered->leading_dim = (order == ANDA_ORDER_COLUMN_MAJOR) ? sizes[0] : sizes[dims - 1];
+	for (size_t d = 0; d < dims; d++) {
+		ordered->sizes[d] = sizes[d];
+	}
+	return ordered;
+}
+
+
+ndArrayOrdered* alloc_nd_array_ordered (const size_t sizes[], size_t dims, size_t elem_size, unsigned int order) {
+	ndArrayOrdered* ptr = alloc_ordered_impl(sizes, dims, elem_size, order, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_nd_array_ordered";
+	return ptr;
+}
+
+
+ndArrayOrdered* calloc_nd_array_ordered (const size_t sizes[], size_t dims, size_t elem_size, unsigned int order) {
+	ndArrayOrdered* ptr = alloc_ordered_impl(sizes, dims, elem_size, order, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_nd_array_ordered";
+	return ptr;
+}
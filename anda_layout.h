@@ -0,0 +1,234 @@
+/*
+ * anda_layout.h -- interface for alternative memory layouts of multi-dimensional
+ *                  arrays
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#pragma once
+
+#ifndef ANDA_LAYOUT_H
+#define ANDA_LAYOUT_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * The arrays in this header are freed with a single free() like those of
+ * alloc_nd_array, but their blocks are organized differently.
+ *
+ * Interleaved arrays are indexed exactly like standard ones, but functions that depend
+ * on the standard layout (realloc_nd_array, rebase_nd_array, clone_nd_array and the
+ * like) must not be used with them.
+ *
+ * Column-major arrays keep the first dimension contiguous, as Fortran and LAPACK expect.
+ * Their block is the standard block of the reversed shape, so they are indexed with the
+ * indices reversed (a[j][i] for element (i, j)), and the functions of the standard
+ * layout accept them when given the reversed sizes. A plain block does not record its
+ * order, so the order must be passed again wherever it matters. alloc_nd_array_ordered
+ * instead returns a descriptor that records the shape, the order, the data pointer and
+ * the leading dimension together with the array, for handing to column-major routines.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+/*
+ * alloc_nd_array_interleaved
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 3+ dimensions but supports 1D and 2D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the multi-dimensional array or NULL on failure
+ * @note: Only the top-level pointer table is kept at the front of the block. Each outer slab a[i] is laid out as its own (dims - 1)-dimensional array, with its pointer tables immediately followed by its data, so a sweep over one slab touches pointers and data that share pages instead of a pointer page far away from the data. For 1D and 2D arrays this layout is the same as that of alloc_nd_array. The data of one slab is contiguous, but the slabs are separated by their pointer tables. The allocated memory must be freed using free() when no longer needed. The returned memory is uninitialized.
+ */
+extern void* alloc_nd_array_interleaved (const size_t sizes[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_nd_array_interleaved_t
+ */
+#define alloc_nd_array_interleaved_t(sizes, dims, elem_type) \
+	alloc_nd_array_interleaved((sizes), (dims), sizeof(elem_type))
+
+
+/*
+ * calloc_nd_array_interleaved
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 3+ dimensions but supports 1D and 2D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the multi-dimensional array or NULL on failure
+ * @note: Same as alloc_nd_array_interleaved, except that the elements are set to zero.
+ */
+extern void* calloc_nd_array_interleaved (const size_t sizes[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_nd_array_interleaved_t
+ */
+#define calloc_nd_array_interleaved_t(sizes, dims, elem_type) \
+	calloc_nd_array_interleaved((sizes), (dims), sizeof(elem_type))
+
+
+/* Orders for alloc_nd_array_order and alloc_nd_array_ordered */
+#define ANDA_ORDER_ROW_MAJOR     0u  /* last dimension contiguous (C order, same as alloc_nd_array) */
+#define ANDA_ORDER_COLUMN_MAJOR  1u  /* first dimension contiguous (Fortran order) */
+
+
+/*
+ * alloc_nd_array_order
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims), in the order of the mathematical indices (e.g., rows, columns)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param order: ANDA_ORDER_ROW_MAJOR or ANDA_ORDER_COLUMN_MAJOR
+ * @return: pointer to the multi-dimensional array or NULL on failure
+ * @note: With ANDA_ORDER_COLUMN_MAJOR, element (i, j, ...) sits at i + sizes[0] * (j + sizes[1] * ...) in the data and is accessed as a[...][j][i]; the data can be passed directly to column-major routines with a leading dimension of sizes[0] (see get_nd_array_data). The allocated memory must be freed using free() when no longer needed. The returned memory is uninitialized.
+ */
+extern void* alloc_nd_array_order (const size_t sizes[], size_t dims, size_t elem_size, unsigned int order);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_nd_array_order_t
+ */
+#define alloc_nd_array_order_t(sizes, dims, elem_type, order) \
+	alloc_nd_array_order((sizes), (dims), sizeof(elem_type), (order))
+
+
+/*
+ * calloc_nd_array_order
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims), in the order of the mathematical indices (e.g., rows, columns)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param order: ANDA_ORDER_ROW_MAJOR or ANDA_ORDER_COLUMN_MAJOR
+ * @return: pointer to the multi-dimensional array or NULL on failure
+ * @note: Same as alloc_nd_array_order, except that the elements are set to zero.
+ */
+extern void* calloc_nd_array_order (const size_t sizes[], size_t dims, size_t elem_size, unsigned int order);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_nd_array_order_t
+ */
+#define calloc_nd_array_order_t(sizes, dims, elem_type, order) \
+	calloc_nd_array_order((sizes), (dims), sizeof(elem_type), (order))
+
+
+/*
+ * get_nd_array_data
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_order, calloc_nd_array_order, alloc_nd_array or calloc_nd_array
+ * @param sizes: the sizes the array was allocated with (must have length equal to dims)
+ * @param dims: number of array dimensions (must be the same as when the array was allocated)
+ * @param elem_size: size of each element in bytes (must be the same as when the array was allocated)
+ * @param order: the order the array was allocated with (ANDA_ORDER_ROW_MAJOR for alloc_nd_array and calloc_nd_array)
+ * @return: pointer to the first element of the contiguous data, or NULL on failure
+ * @note: For a column-major array this is the pointer to hand to Fortran or LAPACK routines, with no copy or transposition.
+ */
+extern void* get_nd_array_data (void* array, const size_t sizes[], size_t dims, size_t elem_size, unsigned int order);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * get_nd_array_data_t
+ */
+#define get_nd_array_data_t(array, sizes, dims, elem_type, order) \
+	get_nd_array_data((array), (sizes), (dims), sizeof(elem_type), (order))
+
+
+typedef struct {
+	void* array;           /* the multi-dimensional array (indexed with the indices reversed when column-major) */
+	void* data;            /* first element of the contiguous data */
+	size_t dims;           /* number of dimensions */
+	size_t elem_size;      /* size of each element in bytes */
+	unsigned int order;    /* ANDA_ORDER_ROW_MAJOR or ANDA_ORDER_COLUMN_MAJOR */
+	size_t leading_dim;    /* leading dimension in elements (sizes[0] when column-major, sizes[dims - 1] when row-major) */
+	size_t sizes[];        /* sizes in the order of the mathematical indices */
+} ndArrayOrdered;
+
+
+/*
+ * alloc_nd_array_ordered
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims), in the order of the mathematical indices (e.g., rows, columns)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param order: ANDA_ORDER_ROW_MAJOR or ANDA_ORDER_COLUMN_MAJOR
+ * @return: pointer to the descriptor or NULL on failure
+ * @note: The array is laid out as by alloc_nd_array_order and lives in the same block as the descriptor, so free() on the descriptor releases both; the array itself must not be passed to free(). The returned array is uninitialized.
+ */
+extern ndArrayOrdered* alloc_nd_array_ordered (const size_t sizes[], size_t dims, size_t elem_size, unsigned int order);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_nd_array_ordered_t
+ */
+#define alloc_nd_array_ordered_t(sizes, dims, elem_type, order) \
+	alloc_nd_array_ordered((sizes), (dims), sizeof(elem_type), (order))
+
+
+/*
+ * calloc_nd_array_ordered
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims), in the order of the mathematical indices (e.g., rows, columns)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param order: ANDA_ORDER_ROW_MAJOR or ANDA_ORDER_COLUMN_MAJOR
+ * @return: pointer to the descriptor or NULL on failure
+ * @note: Same as alloc_nd_array_ordered, except that the elements are set to zero.
+ */
+extern ndArrayOrdered* calloc_nd_array_ordered (const size_t sizes[], size_t dims, size_t elem_size, unsigned int order);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_nd_array_ordered_t
+ */
+#define calloc_nd_array_ordered_t(sizes, dims, elem_type, order) \
+	calloc_nd_array_ordered((sizes), (dims), sizeof(elem_type), (order))
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
@@ -135,6 +135,110 @@ extern void* allocate_and_initialize_nd_array (const size_t sizes[], size_t dims
 	allocate_and_initialize_nd_array((sizes), (dims), sizeof(elem_type), (size_ptrs), (size_padding), (total_elements), (alloc_func))
 
 
+/*
+ * initialize_nd_array
+ * @param block: pointer to a memory block of at least size_ptrs + size_padding + (total_elements * elem_size) bytes
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param size_ptrs: size of the pointer array (not including padding)
+ * @param size_padding: size of the padding
+ * @param total_elements: total number of elements in the array
+ * @return: block, with its pointer tables set up to reference the data region inside the block
+ * @note: This function builds the pointer tables in memory obtained by other means (e.g., a memory pool or a mapped region). It does not touch the data region. The block must be suitably aligned for both pointers and elements.
+ */
+extern void* initialize_nd_array (void* block, const size_t sizes[], size_t dims, size_t elem_size, size_t size_ptrs, size_t size_padding, size_t total_elements);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * initialize_nd_array_t
+ */
+#define initialize_nd_array_t(block, sizes, dims, elem_type, size_ptrs, size_padding, total_elements) \
+	initialize_nd_array((block), (sizes), (dims), sizeof(elem_type), (size_ptrs), (size_padding), (total_elements))
+
+
+/* Flags for calculate_nd_array_size_ex and initialize_nd_array_ex */
+#define ANDA_SHAPE_REVERSED  0x01u  /* read sizes from the last dimension to the first (the layout used for column-major arrays) */
+
+
+/*
+ * calculate_nd_array_size_ex
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param flags: combination of ANDA_SHAPE_* flags
+ * @param result_ptrs_size: pointer to store the size of the pointer array (not including padding)
+ * @param result_padding_size: pointer to store the size of the padding
+ * @param result_total_elements: pointer to store the total number of elements in the array
+ * @return: true if the size was successfully calculated, false if an error occurred
+ * @note: Same as calculate_nd_array_size, but with ANDA_SHAPE_REVERSED the sizes are read in reverse order without copying them.
+ */
+extern bool calculate_nd_array_size_ex (const size_t sizes[], size_t dims, size_t elem_size, unsigned int flags, size_t* result_ptrs_size, size_t* result_padding_size, size_t* result_total_elements);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calculate_nd_array_size_ex_t
+ */
+#define calculate_nd_array_size_ex_t(sizes, dims, elem_type, flags, result_ptrs_size, result_padding_size, result_total_elements) \
+	calculate_nd_array_size_ex((sizes), (dims), sizeof(elem_type), (flags), (result_ptrs_size), (result_padding_size), (result_total_elements))
+
+
+/*
+ * initialize_nd_array_ex
+ * @param block: pointer to a memory block of at least size_ptrs + size_padding + (total_elements * elem_size) bytes
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param flags: combination of ANDA_SHAPE_* flags (must match those passed to calculate_nd_array_size_ex)
+ * @param size_ptrs: size of the pointer array (not including padding)
+ * @param size_padding: size of the padding
+ * @param total_elements: total number of elements in the array
+ * @return: block, with its pointer tables set up to reference the data region inside the block
+ * @note: Same as initialize_nd_array, with the shape options of calculate_nd_array_size_ex.
+ */
+extern void* initialize_nd_array_ex (void* block, const size_t sizes[], size_t dims, size_t elem_size, unsigned int flags, size_t size_ptrs, size_t size_padding, size_t total_elements);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * initialize_nd_array_ex_t
+ */
+#define initialize_nd_array_ex_t(block, sizes, dims, elem_type, flags, size_ptrs, size_padding, total_elements) \
+	initialize_nd_array_ex((block), (sizes), (dims), sizeof(elem_type), (flags), (size_ptrs), (size_padding), (total_elements))
+
+
+/*
+ * relayout_nd_array
+ * @param dst_block: block that receives the array in the layout of new_sizes (may be the same as src_block)
+ * @param src_block: block that holds the array in the layout of old_sizes
+ * @param old_sizes: sizes of the array in src_block (must have length equal to dims)
+ * @param new_sizes: sizes of the array in dst_block (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param zero_fill: true to set the elements that exist only in the new shape to zero
+ * @return: dst_block with its pointer tables rebuilt for new_sizes, or NULL on failure
+ * @note: Every element whose indices are valid in both shapes is carried over row by row. When dst_block is the same as src_block, the block must be large enough for both layouts, and either every dimension must grow or every dimension must shrink (otherwise errno is set to EINVAL and nothing is changed). Different blocks must not overlap.
+ */
+extern void* relayout_nd_array (void* dst_block, void* src_block, const size_t old_sizes[], const size_t new_sizes[], size_t dims, size_t elem_size, bool zero_fill);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * relayout_nd_array_t
+ */
+#define relayout_nd_array_t(dst_block, src_block, old_sizes, new_sizes, dims, elem_type, zero_fill) \
+	relayout_nd_array((dst_block), (src_block), (old_sizes), (new_sizes), (dims), sizeof(elem_type), (zero_fill))
+
+
+/*
+ * rebase_pointer_table
+ * @param table: pointer to the first pointer to adjust
+ * @param count: number of pointers to adjust
+ * @param old_base: address the pointed-to region had when the pointers were written
+ * @param new_base: address the pointed-to region has now
+ * @note: This function adds (new_base - old_base) to every pointer, using SSE2, AVX2 or NEON when available. Pointers into different regions (e.g., separate pointer levels that moved by different distances) can be adjusted with one call per region.
+ */
+extern void rebase_pointer_table (void** table, size_t count, const void* old_base, const void* new_base);
+
+
 #if defined(__GNUC__) && !defined(__clang__)
 	#pragma GCC diagnostic pop  /* -Wunused-macros */
 #endif
@@ -0,0 +1,776 @@
+/*
+ * anda_mmap.c -- implementation for multi-dimensional arrays backed directly by
+ *                memory mappings
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+#if defined (__linux__) && !defined (_GNU_SOURCE)
+	#define _GNU_SOURCE  /* mremap, memfd_create, fallocate */
+#endif
+
+#include "anda_mmap.h"
+#include "anda_llapi.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#if defined (__linux__)
+	#include <fcntl.h>
+#endif
+
+#if defined (__GLIBC__)
+	#include <malloc.h>
+#endif
+
+#include "cver_compat.h"
+
+
+#if !defined (__unix__) && !defined (__APPLE__)
+	#error "anda_mmap.c requires a POSIX environment (mmap)."
+#endif
+
+
+#if !defined (MAP_ANONYMOUS) && defined (MAP_ANON)
+	#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#if defined (__linux__) && defined (MFD_CLOEXEC)
+	#define ANDA_MMAP_HAS_MEMFD
+#endif
+
+
+#define MMAP_HEADER_SIZE 64  /* マッピング先頭に置く隠しヘッダの領域 (配列の先頭をキャッシュライン境界に揃える) */
+#define MMAP_MAGIC ((uint32_t)0x414E4441)  /* "ANDA" */
+
+
+/* マッピング先頭に置く隠しヘッダ */
+typedef struct {
+	size_t map_size;        /* マッピング全体のバイト数 (ヘッダ込み) */
+	size_t ptrs_size;       /* ポインタテーブルのバイト数 (パディングを含まない) */
+	size_t data_offset;     /* 配列先頭からデータ部分までのオフセット */
+	size_t data_size;       /* データ部分のバイト数 (外側のスラブをページ境界に揃えた場合はその詰め物を含む) */
+	size_t slab_stride;     /* 外側のスラブの間隔 (ページ境界に揃えていない標準の配置では0) */
+	unsigned int flags;     /* 実際に有効になっている ANDA_MMAP_* フラグ */
+	int fd;                 /* マッピングの元になっている memfd (匿名マッピングの場合は -1) */
+	uint32_t magic;
+} mmapHeader;
+
+_Static_assert(sizeof(mmapHeader) <= MMAP_HEADER_SIZE, "mmapHeader must fit in MMAP_HEADER_SIZE");
+
+
+static inline mmapHeader* header_of (const void* array) {
+	return (mmapHeader*)(void*)((uintptr_t)array - MMAP_HEADER_SIZE);
+}
+
+
+static size_t page_size (void) {
+	long size = sysconf(_SC_PAGESIZE);
+	return (size > 0) ? (size_t)size : 4096;
+}
+
+
+/* 全ページに書き込んで事前にフォルトさせる (ゼロページはカーネルがこの時に用意する) */
+static void touch_pages (char* addr, size_t size) {
+	size_t step = page_size();
+	for (size_t offset = 0; offset < size; offset += step) {
+		((volatile char*)addr)[offset] = 0;
+	}
+}
+
+
+static void populate_pages (void* addr, size_t size) {
+#ifdef MADV_POPULATE_WRITE
+	if (madvise(addr, size, MADV_POPULATE_WRITE) == 0) return;
+#endif
+	touch_pages(addr, size);
+}
+
+
+static unsigned int commit_pages (void* map, size_t map_size, unsigned int flags) {
+	unsigned int effective = 0;
+
+	if (flags & ANDA_MMAP_HUGEPAGE) {
+#ifdef MADV_HUGEPAGE
+		if (madvise(map, map_size, MADV_HUGEPAGE) == 0) effective |= ANDA_MMAP_HUGEPAGE;
+#endif
+	}
+
+	if (flags & ANDA_MMAP_POPULATE) {  /* ヒュージページの指定を先に済ませてからフォルトさせる */
+		populate_pages(map, map_size);
+		effective |= ANDA_MMAP_POPULATE;
+	}
+
+	if (flags & ANDA_MMAP_LOCK) {
+		if (mlock(map, map_size) == 0) effective |= ANDA_MMAP_LOCK;
+	}
+
+	return effective;
+}
+
+
+/* ANDA_MMAP_MEMFD が指定されていれば memfd を共有でマップし、作れなければ匿名マッピングにする */
+static void* map_pages (size_t map_size, unsigned int flags, int* fd) {
+	*fd = -1;
+
+#ifdef ANDA_MMAP_HAS_MEMFD
+	if (flags & ANDA_MMAP_MEMFD) {
+		int memfd = memfd_create("alloc_nd_array", MFD_CLOEXEC);
+		if (memfd >= 0) {
+			void* map = MAP_FAILED;
+			if (map_size <= (size_t)INT64_MAX && ftruncate(memfd, (off_t)map_size) == 0)
+				map = mmap(PTR_NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+			if (map != MAP_FAILED) {
+				*fd = memfd;
+				return map;
+			}
+			close(memfd);
+		}
+	}
+#else
+	(void)flags;
+#endif
+
+	return mmap(PTR_NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+}
+
+
+/* 外側のスラブごとにデータの先頭をページ境界に揃える配置を計算する (KSM がスラブ単位で同じページを見つけられるようにする) */
+static bool mergeable_layout (size_t outer, size_t size_ptrs, size_t* data_offset, size_t* data_size, size_t* slab_stride) {
+	size_t page = page_size();
+	size_t stride = anda_align_up(*data_size / outer, page);
+	size_t offset = anda_align_up(MMAP_HEADER_SIZE + size_ptrs, page);  /* size_ptrs はデータ部分より小さいので溢れない */
+	if (stride == 0 || offset == 0 || stride > SIZE_MAX / outer) return false;
+
+	*data_offset = offset - MMAP_HEADER_SIZE;
+	*data_size = outer * stride;
+	*slab_stride = stride;
+	return true;
+}
+
+
+/* 連続した配置で作ったポインタテーブルの最下層を、ページ境界に揃えた各スラブへ向け直す */
+static void spread_outer_slabs (char* array, size_t outer, size_t size_ptrs, size_t data_offset, size_t row_size, size_t rows, size_t slab_stride) {
+	void** bottom = (void**)(void*)(array + size_ptrs) - rows;
+	size_t rows_per_slab = rows / outer;
+	char* data = array + data_offset;
+
+	for (size_t i = 0; i < rows; i++) {
+		bottom[i] = data + (i / rows_per_slab) * slab_stride + (i % rows_per_slab) * row_size;
+	}
+}
+
+
+void* alloc_nd_array_mmap (const size_t sizes[], size_t dims, size_t elem_size, unsigned int flags) {
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_nd_array_size(sizes, dims, elem_size, &size_ptrs, &size_padding, &total_elements)) {
+		anda_errfunc = "alloc_nd_array_mmap";
+		return PTR_NULL;
+	}
+
+	size_t data_offset = size_ptrs + size_padding;
+	size_t data_size = total_elements * elem_size;
+	size_t slab_stride = 0;
+	if ((flags & ANDA_MMAP_MERGEABLE) && dims >= 2) {  /* 1次元ではスラブが1つなので揃えない */
+		if (!mergeable_layout(sizes[0], size_ptrs, &data_offset, &data_size, &slab_stride)) {
+			errno = EINVAL;
+			anda_errfunc = "alloc_nd_array_mmap";
+			return PTR_NULL;
+		}
+		size_padding = data_offset - size_ptrs;
+	}
+
+	if (data_offset > SIZE_MAX - MMAP_HEADER_SIZE - data_size) {
+		errno = EINVAL;
+		anda_errfunc = "alloc_nd_array_mmap";
+		return PTR_NULL;
+	}
+
+	size_t map_size = anda_align_up(MMAP_HEADER_SIZE + data_offset + data_size, page_size());
+	if (map_size == 0) {
+		errno = EINVAL;
+		anda_errfunc = "alloc_nd_array_mmap";
+		return PTR_NULL;
+	}
+
+	int fd;
+	void* map = map_pages(map_size, flags, &fd);
+	if (UNLIKELY(map == MAP_FAILED)) {
+		errno = ENOMEM;
+		anda_errfunc = "alloc_nd_array_mmap";
+		return PTR_NULL;
+	}
+
+	mmapHeader* header = map;
+	header->map_size = map_size;
+	header->ptrs_size = size_ptrs;
+	header->data_offset = data_offset;
+	header->data_size = data_size;
+	header->slab_stride = slab_stride;
+	header->fd = fd;
+	header->magic = MMAP_MAGIC;
+	header->flags = commit_pages(map, map_size, flags) | ((fd >= 0) ? ANDA_MMAP_MEMFD : 0);
+
+#ifdef MADV_MERGEABLE
+	/* KSM は共有マッピング (memfd) を対象にしないので、madvise が成功しても効果が無い */
+	if ((flags & ANDA_MMAP_MERGEABLE) && fd < 0 && madvise(map, map_size, MADV_MERGEABLE) == 0) header->flags |= ANDA_MMAP_MERGEABLE;
+#endif
+
+	char* base = (char*)map + MMAP_HEADER_SIZE;
+	initialize_nd_array(base, sizes, dims, elem_size, size_ptrs, size_padding, total_elements);
+	if (slab_stride != 0)
+		spread_outer_slabs(base, sizes[0], size_ptrs, data_offset, sizes[dims - 1] * elem_size, total_elements / sizes[dims - 1], slab_stride);
+	return base;
+}
+
+
+void free_nd_array_mmap (void* array) {
+	if (array == PTR_NULL) return;
+
+	mmapHeader* header = header_of(array);
+	if (UNLIKELY(header->magic != MMAP_MAGIC)) {
+		errno = EINVAL;
+		anda_errfunc = "free_nd_array_mmap";
+		return;
+	}
+
+	int fd = header->fd;
+	header->magic = 0;
+	munmap(header, header->map_size);
+	if (fd >= 0) close(fd);
+}
+
+
+unsigned int get_nd_array_mmap_flags (const void* array) {
+	if (array == PTR_NULL || header_of(array)->magic != MMAP_MAGIC) {
+		errno = EINVAL;
+		anda_errfunc = "get_nd_array_mmap_flags";
+		return 0;
+	}
+
+	return header_of(array)->flags;
+}
+
+
+static bool all_dims_grow (const size_t old_sizes[], const size_t new_sizes[], size_t dims) {
+	for (size_t d = 0; d < dims; d++) {
+		if (new_sizes[d] < old_sizes[d]) return false;
+	}
+	return true;
+}
+
+
+static bool all_dims_shrink (const size_t old_sizes[], const size_t new_sizes[], size_t dims) {
+	for (size_t d = 0; d < dims; d++) {
+		if (new_sizes[d] > old_sizes[d]) return false;
+	}
+	return true;
+}
+
+
+/* ポインタテーブルをたどって、両方の形状に含まれる行をコピーする (スラブをページ境界に揃えた配置でも使える) */
+static void copy_rows_by_table (void* dst, void* src, const size_t old_sizes[], const size_t new_sizes[], size_t dims, size_t elem_size) {
+	size_t count = (old_sizes[0] < new_sizes[0]) ? old_sizes[0] : new_sizes[0];
+	if (dims == 1) {
+		memcpy(dst, src, count * elem_size);
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		copy_rows_by_table(((void**)dst)[i], ((void**)src)[i], old_sizes + 1, new_sizes + 1, dims - 1, elem_size);
+	}
+}
+
+
+/* 新しい形状を別のマッピングへ行ごとにコピーして、古いマッピングを解放する */
+static void* realloc_by_copy (void* array, const size_t old_sizes[], const size_t new_sizes[], size_t dims, size_t elem_size) {
+	unsigned int flags = header_of(array)->flags;
+	/* KSM に登録できなかった場合も配置は引き継ぐ (memfd では KSM が効かないので引き継がない) */
+	if (header_of(array)->slab_stride != 0 && header_of(array)->fd < 0) flags |= ANDA_MMAP_MERGEABLE;
+
+	void* new_array = alloc_nd_array_mmap(new_sizes, dims, elem_size, flags);  /* memfd も新しく作る */
+	if (UNLIKELY(new_array == PTR_NULL)) return PTR_NULL;
+
+	/* 新しいマッピングは元からゼロ */
+	if (header_of(array)->slab_stride != 0 || header_of(new_array)->slab_stride != 0)
+		copy_rows_by_table(new_array, array, old_sizes, new_sizes, dims, elem_size);
+	else
+		relayout_nd_array(new_array, array, old_sizes, new_sizes, dims, elem_size, false);
+	free_nd_array_mmap(array);
+	return new_array;
+}
+
+
+void* realloc_nd_array_mmap (void* array, const size_t old_sizes[], const size_t new_sizes[], size_t dims, size_t elem_size) {
+	if (array == PTR_NULL) {
+		void* ptr = alloc_nd_array_mmap(new_sizes, dims, elem_size, 0);
+		if (ptr == PTR_NULL) anda_errfunc = "realloc_nd_array_mmap";
+		return ptr;
+	}
+
+	size_t new_ptrs, new_padding, new_total, old_ptrs, old_padding, old_total;
+	if (header_of(array)->magic != MMAP_MAGIC || (header_of(array)->flags & ANDA_MMAP_SNAPSHOT) ||
+		!calculate_nd_array_size(old_sizes, dims, elem_size, &old_ptrs, &old_padding, &old_total) ||
+		!calculate_nd_array_size(new_sizes, dims, elem_size, &new_ptrs, &new_padding, &new_total)) {
+		errno = EINVAL;
+		anda_errfunc = "realloc_nd_array_mmap";
+		return PTR_NULL;
+	}
+
+	mmapHeader* header = header_of(array);
+	size_t data_offset = new_ptrs + new_padding;
+	size_t data_size = new_total * elem_size;
+	if (data_offset > SIZE_MAX - MMAP_HEADER_SIZE - data_size) {
+		errno = EINVAL;
+		anda_errfunc = "realloc_nd_array_mmap";
+		return PTR_NULL;
+	}
+	size_t map_size = anda_align_up(MMAP_HEADER_SIZE + data_offset + data_size, page_size());
+	if (map_size == 0) {
+		errno = EINVAL;
+		anda_errfunc = "realloc_nd_array_mmap";
+		return PTR_NULL;
+	}
+
+	if (header->slab_stride != 0) {  /* スラブをページ境界に揃えた配置はその場では組み替えない */
+		void* ptr = realloc_by_copy(array, old_sizes, new_sizes, dims, elem_size);
+		if (ptr == PTR_NULL) anda_errfunc = "realloc_nd_array_mmap";
+		return ptr;
+	} else if (all_dims_grow(old_sizes, new_sizes, dims)) {
+		if (map_size > header->map_size) {
+#ifdef MREMAP_MAYMOVE
+			/* ページテーブルの付け替えだけで広げる (データはコピーされない) */
+			size_t old_map_size = header->map_size;
+			if (header->fd >= 0 && (map_size > (size_t)INT64_MAX || ftruncate(header->fd, (off_t)map_size) != 0)) {  /* 先に memfd を広げる */
+				errno = ENOMEM;
+				anda_errfunc = "realloc_nd_array_mmap";
+				return PTR_NULL;
+			}
+			void* map = mremap(header, old_map_size, map_size, MREMAP_MAYMOVE);
+			if (UNLIKELY(map == MAP_FAILED)) {
+				errno = ENOMEM;
+				anda_errfunc = "realloc_nd_array_mmap";
+				return PTR_NULL;
+			}
+			header = map;
+			header->map_size = map_size;
+			if (header->flags & ANDA_MMAP_POPULATE) populate_pages((char*)map + old_map_size, map_size - old_map_size);
+			array = (char*)map + MMAP_HEADER_SIZE;
+#else
+			void* ptr = realloc_by_copy(array, old_sizes, new_sizes, dims, elem_size);
+			if (ptr == PTR_NULL) anda_errfunc = "realloc_nd_array_mmap";
+			return ptr;
+#endif
+		}
+		relayout_nd_array(array, array, old_sizes, new_sizes, dims, elem_size, true);
+	} else if (all_dims_shrink(old_sizes, new_sizes, dims)) {
+		relayout_nd_array(array, array, old_sizes, new_sizes, dims, elem_size, true);
+		if (map_size < header->map_size) {  /* 末尾のページだけを解放する (その場で縮むので移動しない) */
+			munmap((char*)header + map_size, header->map_size - map_size);
+			if (header->fd >= 0) (void)!ftruncate(header->fd, (off_t)map_size);  /* 縮めるだけなので失敗しても中身は正しい */
+			header->map_size = map_size;
+		}
+	} else {
+		void* ptr = realloc_by_copy(array, old_sizes, new_sizes, dims, elem_size);
+		if (ptr == PTR_NULL) anda_errfunc = "realloc_nd_array_mmap";
+		return ptr;
+	}
+
+	header->ptrs_size = new_ptrs;
+	header->data_offset = data_offset;
+	header->data_size = data_size;
+	return array;
+}
+
+/* ページを捨てる (共有の memfd では MADV_DONTNEED してもファイルの内容が残るので穴を開ける) */
+static bool discard_pages (mmapHeader* header, char* start, size_t size) {
+	if (header->fd < 0) return madvise(start, size, MADV_DONTNEED) == 0;
+
+#if defined (ANDA_MMAP_HAS_MEMFD) && defined (FALLOC_FL_PUNCH_HOLE)
+	off_t offset = (off_t)(start - (char*)header);
+	return fallocate(header->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, (off_t)size) == 0;
+#else
+	return false;
+#endif
+}
+
+
+bool zero_nd_array_mmap (void* array) {
+	if (array == PTR_NULL || header_of(array)->magic != MMAP_MAGIC) {
+		errno = EINVAL;
+		anda_errfunc = "zero_nd_array_mmap";
+		return false;
+	}
+
+	mmapHeader* header = header_of(array);
+	char* data = (char*)array + header->data_offset;
+	size_t size = header->data_size;
+
+	/*
+	 * 常駐させておく必要がない大きな領域は、ページを捨ててゼロページとして再フォルトさせる
+	 * (スナップショットでページを捨てると memfd の内容が見えるだけなので対象外)
+	 */
+	if (size >= ANDA_ZERO_MADVISE_MIN_BYTES && (header->flags & (ANDA_MMAP_POPULATE | ANDA_MMAP_LOCK | ANDA_MMAP_SNAPSHOT)) == 0) {
+		uintptr_t page_mask = (uintptr_t)(page_size() - 1);
+		char* start = (char*)(((uintptr_t)data + page_mask) & ~page_mask);
+		char* end = (char*)(((uintptr_t)data + size) & ~page_mask);
+
+		if (start < end && discard_pages(header, start, (size_t)(end - start))) {
+			/* ページ境界に揃わない先頭と末尾だけを memset する (先頭側はポインタテーブルと同じページにある) */
+			memset(data, 0, (size_t)(start - data));
+			memset(end, 0, (size_t)((data + size) - end));
+			return true;
+		}
+	}
+
+	memset(data, 0, size);
+	return true;
+}
+
+void* snapshot_nd_array_mmap (const void* array) {
+	if (array == PTR_NULL || header_of(array)->magic != MMAP_MAGIC ||
+		header_of(array)->fd < 0 || (header_of(array)->flags & ANDA_MMAP_SNAPSHOT)) {
+		errno = EINVAL;
+		anda_errfunc = "snapshot_nd_array_mmap";
+		return PTR_NULL;
+	}
+
+	const mmapHeader* header = header_of(array);
+	int fd = dup(header->fd);  /* スナップショットは自分の fd を持ち、元の配列とは別に閉じる */
+	if (UNLIKELY(fd < 0)) {
+		anda_errfunc = "snapshot_nd_array_mmap";
+		return PTR_NULL;
+	}
+
+	/* 同じ memfd を別のアドレスにプライベートでマップする (書き込まれたページだけがコピーされる) */
+	void* map = mmap(PTR_NULL, header->map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (UNLIKELY(map == MAP_FAILED)) {
+		close(fd);
+		errno = ENOMEM;
+		anda_errfunc = "snapshot_nd_array_mmap";
+		return PTR_NULL;
+	}
+
+	mmapHeader* snapshot_header = map;
+	snapshot_header->fd = fd;
+	snapshot_header->flags = ANDA_MMAP_SNAPSHOT;
+
+	/* ポインタテーブルは全て元の配列のアドレスを指しているので、新しいアドレスに付け替える (コピーされるのはこのページだけ) */
+	char* snapshot = (char*)map + MMAP_HEADER_SIZE;
+	rebase_pointer_table((void**)(void*)snapshot, header->ptrs_size / sizeof(void*), array, snapshot);
+	return snapshot;
+}
+
+/* "名前 値" の形式の行が並ぶファイルから、指定した名前の値を読む */
+static bool read_stat_value (FILE* fp, const char* name, long long* value) {
+	char line[128];
+	size_t length = strlen(name);
+
+	rewind(fp);
+	while (fgets(line, sizeof(line), fp) != PTR_NULL) {
+		if (strncmp(line, name, length) == 0 && line[length] == ' ') {
+			*value = strtoll(line + length + 1, PTR_NULL, 10);
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/* ksm_stat が無いカーネルでは smaps の各マッピングの "KSM:" (kB 単位) を合計する */
+static bool read_smaps_ksm (size_t* bytes) {
+	FILE* fp = fopen("/proc/self/smaps", "r");
+	if (fp == PTR_NULL) return false;
+
+	char line[256];
+	bool found = false;
+	size_t total = 0;
+	while (fgets(line, sizeof(line), fp) != PTR_NULL) {
+		if (strncmp(line, "KSM:", 4) == 0) {
+			total += (size_t)strtoull(line + 4, PTR_NULL, 10) * 1024;
+			found = true;
+		}
+	}
+	fclose(fp);
+
+	*bytes = total;
+	return found;
+}
+
+
+bool get_nd_array_ksm_stats (ndArrayKsmStats* result_stats) {
+	if (result_stats == PTR_NULL) {
+		errno = EINVAL;
+		anda_errfunc = "get_nd_array_ksm_stats";
+		return false;
+	}
+
+	size_t page = page_size();
+	FILE* fp = fopen("/proc/self/ksm_stat", "r");
+	if (fp != PTR_NULL) {
+		long long merging = 0, zero = 0, profit = 0;
+		bool valid = read_stat_value(fp, "ksm_merging_pages", &merging);
+		read_stat_value(fp, "ksm_zero_pages", &zero);  /* 古いカーネルには無い */
+		bool has_profit = read_stat_value(fp, "ksm_process_profit", &profit);
+		fclose(fp);
+
+		if (valid) {
+			result_stats->merging_pages = (merging > 0) ? (size_t)merging : 0;
+			result_stats->zero_pages = (zero > 0) ? (size_t)zero : 0;
+			result_stats->saved_bytes = (result_stats->merging_pages + result_stats->zero_pages) * page;
+			result_stats->profit_bytes = has_profit ? (ptrdiff_t)profit : (ptrdiff_t)result_stats->saved_bytes;
+			return true;
+		}
+	}
+
+	size_t bytes;
+	if (!read_smaps_ksm(&bytes)) {
+		errno = ENOTSUP;
+		anda_errfunc = "get_nd_array_ksm_stats";
+		return false;
+	}
+
+	result_stats->merging_pages = bytes / page;
+	result_stats->zero_pages = 0;
+	result_stats->saved_bytes = bytes;
+	result_stats->profit_bytes = (ptrdiff_t)bytes;
+	return true;
+}
+
+/* 解放待ちブロックのキュー (マッピングの場合は解放するブロック自身の中に置く) */
+typedef struct reclaimNode {
+	struct reclaimNode* next;
+	void* block;
+	size_t bytes;
+	bool mapped;
+} reclaimNode;
+
+static pthread_mutex_t reclaim_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reclaim_queued = PTHREAD_COND_INITIALIZER;   /* キューに積まれた、または停止要求があった */
+static pthread_cond_t reclaim_drained = PTHREAD_COND_INITIALIZER;  /* キューが空になった */
+static pthread_t reclaim_thread;
+static bool reclaim_running = false;
+static bool reclaim_stopping = false;
+static unsigned int reclaim_flags = 0;
+static reclaimNode* reclaim_head = PTR_NULL;
+static ndArrayReclaimStats reclaim_stats = {0, 0, 0, 0};
+
+
+static void release_node (reclaimNode* node) {
+	if (node->mapped) {
+		free_nd_array_mmap(node->block);  /* node はこのマッピングの中にあるので以降は参照しない */
+	} else {
+		free(node->block);
+		free(node);
+	}
+}
+
+
+static void* reclaimer_main (void* arg) {
+	(void)arg;
+
+	pthread_mutex_lock(&reclaim_mutex);
+	for (;;) {
+		while (reclaim_head == PTR_NULL && !reclaim_stopping)
+			pthread_cond_wait(&reclaim_queued, &reclaim_mutex);
+		if (reclaim_head == PTR_NULL) break;  /* 停止要求があり、キューも空 */
+
+		/* キューをまとめて取り出し、ロックを外して処理する */
+		reclaimNode* batch = reclaim_head;
+		reclaim_head = PTR_NULL;
+		unsigned int flags = reclaim_flags;
+		pthread_mutex_unlock(&reclaim_mutex);
+
+#ifdef MADV_FREE
+		/* 先にバッチ全体を MADV_FREE して、個々の munmap を待たずにページを回収可能にする */
+		if (flags & ANDA_RECLAIM_MADV_FREE) {
+			size_t step = page_size();
+			for (reclaimNode* node = batch; node != PTR_NULL; node = node->next) {
+				if (!node->mapped) continue;
+				mmapHeader* header = header_of(node->block);
+				if (header->map_size > step)  /* ヘッダと node を含む先頭ページは残す */
+					madvise((char*)header + step, header->map_size - step, MADV_FREE);
+			}
+		}
+#else
+		(void)flags;
+#endif
+
+		size_t blocks = 0, bytes = 0;
+		while (batch != PTR_NULL) {
+			reclaimNode* next = batch->next;
+			blocks++;
+			bytes += batch->bytes;
+			release_node(batch);
+			batch = next;
+		}
+
+		pthread_mutex_lock(&reclaim_mutex);
+		reclaim_stats.queued_blocks -= blocks;
+		reclaim_stats.queued_bytes -= bytes;
+		reclaim_stats.released_blocks += blocks;
+		reclaim_stats.released_bytes += bytes;
+		if (reclaim_stats.queued_blocks == 0) pthread_cond_broadcast(&reclaim_drained);
+	}
+	pthread_mutex_unlock(&reclaim_mutex);
+
+	return PTR_NULL;
+}
+
+
+/* リクレーマーが動いていればキューに積む (動いていなければ false を返し、呼び出し側で即座に解放する) */
+static bool enqueue_node (reclaimNode* node) {
+	pthread_mutex_lock(&reclaim_mutex);
+	if (!reclaim_running || reclaim_stopping) {
+		pthread_mutex_unlock(&reclaim_mutex);
+		return false;
+	}
+
+	node->next = reclaim_head;
+	reclaim_head = node;
+	reclaim_stats.queued_blocks++;
+	reclaim_stats.queued_bytes += node->bytes;
+	pthread_cond_signal(&reclaim_queued);
+	pthread_mutex_unlock(&reclaim_mutex);
+	return true;
+}
+
+
+bool start_nd_array_reclaimer (unsigned int flags) {
+	pthread_mutex_lock(&reclaim_mutex);
+	reclaim_flags = flags;
+	if (reclaim_running) {
+		pthread_mutex_unlock(&reclaim_mutex);
+		return true;
+	}
+
+	int rc = pthread_create(&reclaim_thread, PTR_NULL, reclaimer_main, PTR_NULL);
+	if (rc != 0) {
+		pthread_mutex_unlock(&reclaim_mutex);
+		errno = rc;
+		anda_errfunc = "start_nd_array_reclaimer";
+		return false;
+	}
+
+	reclaim_running = true;
+	pthread_mutex_unlock(&reclaim_mutex);
+	return true;
+}
+
+
+void free_nd_array_deferred (void* array) {
+	if (array == PTR_NULL) return;
+
+	size_t bytes = 0;
+#if defined (__GLIBC__)
+	bytes = malloc_usable_size(array);
+	if (bytes < ANDA_RECLAIM_MIN_BYTES) {
+		free(array);
+		return;
+	}
+#endif
+
+	reclaimNode* node = malloc(sizeof(reclaimNode));
+	if (UNLIKELY(node == PTR_NULL)) {
+		free(array);
+		return;
+	}
+
+	node->block = array;
+	node->bytes = bytes;
+	node->mapped = false;
+	if (!enqueue_node(node)) release_node(node);
+}
+
+
+void free_nd_array_mmap_deferred (void* array) {
+	if (array == PTR_NULL) return;
+
+	mmapHeader* header = header_of(array);
+	if (UNLIKELY(header->magic != MMAP_MAGIC)) {
+		errno = EINVAL;
+		anda_errfunc = "free_nd_array_mmap_deferred";
+		return;
+	}
+
+	if (header->map_size < ANDA_RECLAIM_MIN_BYTES) {
+		free_nd_array_mmap(array);
+		return;
+	}
+
+	/* もう使われない配列の先頭 (ヘッダ直後) を管理情報の置き場所にする */
+	reclaimNode* node = array;
+	node->block = array;
+	node->bytes = header->map_size;
+	node->mapped = true;
+	if (!enqueue_node(node)) free_nd_array_mmap(array);
+}
+
+
+void flush_nd_array_reclaimer (void) {
+	pthread_mutex_lock(&reclaim_mutex);
+	while (reclaim_stats.queued_blocks != 0)
+		pthread_cond_wait(&reclaim_drained, &reclaim_mutex);
+	pthread_mutex_unlock(&reclaim_mutex);
+}
+
+
+void stop_nd_array_reclaimer (void) {
+	pthread_mutex_lock(&reclaim_mutex);
+	if (!reclaim_running || reclaim_stopping) {
+		pthread_mutex_unlock(&reclaim_mutex);
+		return;
+	}
+	reclaim_stopping = true;
+	pthread_cond_signal(&reclaim_queued);
+	pthread_mutex_unlock(&reclaim_mutex);
+
+	pthread_join(reclaim_thread, PTR_NULL);  /* キューを処理し切ってから終了する */
+
+	pthread_mutex_lock(&reclaim_mutex);
+	reclaim_running = false;
+	reclaim_stopping = false;
+	pthread_mutex_unlock(&reclaim_mutex);
+}
+
+
+bool get_nd_array_reclaim_stats (ndArrayReclaimStats* result_stats) {
+	if (result_stats == PTR_NULL) {
+		errno = EINVAL;
+		anda_errfunc = "get_nd_array_reclaim_stats";
+		return false;
+	}
+
+	pthread_mutex_lock(&reclaim_mutex);
+	*result_stats = reclaim_stats;
+	pthread_mutex_unlock(&reclaim_mutex);
+	return true;
+}
@@ -0,0 +1,268 @@
+/*
+ * anda_mmap.h -- interface for multi-dimensional arrays backed directly by memory
+ *                mappings
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+#pragma once
+
+#ifndef ANDA_MMAP_H
+#define ANDA_MMAP_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * The arrays in this header have the same layout as those of alloc_nd_array, but each
+ * one lives in its own anonymous memory mapping preceded by a small hidden header.
+ * This gives control over how the pages are committed and released, at the cost of
+ * one system call per allocation, so it is meant for large arrays.
+ *
+ * Arrays allocated here must be released with free_nd_array_mmap, never with free()
+ * or free_nd_array. They are always zero-initialized, because the kernel hands out
+ * zero-filled pages.
+ *
+ * With ANDA_MMAP_MEMFD the mapping is a shared view of an anonymous in-memory file
+ * (Linux memfd). Such an array can be snapshotted by mapping the same file privately
+ * at another address: the kernel then copies a page only when one side writes it, so
+ * taking a snapshot costs as much as the pointer tables, not the data.
+ *
+ * With ANDA_MMAP_MERGEABLE the data of each outer slab (a[i] for every i) starts on
+ * its own page and the mapping is registered with KSM (kernel samepage merging), so
+ * slabs with identical contents end up sharing physical pages without any change to
+ * the code that uses the array. get_nd_array_ksm_stats reports how much this saves.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+/* Flags for alloc_nd_array_mmap */
+#define ANDA_MMAP_POPULATE  0x01u  /* fault in every page at allocation time */
+#define ANDA_MMAP_LOCK      0x02u  /* lock the pages in RAM with mlock() */
+#define ANDA_MMAP_HUGEPAGE  0x04u  /* ask for transparent huge pages */
+#define ANDA_MMAP_MEMFD     0x08u  /* back the array with a memfd so that it can be snapshotted (Linux only) */
+#define ANDA_MMAP_SNAPSHOT  0x10u  /* reported by get_nd_array_mmap_flags for arrays created by snapshot_nd_array_mmap */
+#define ANDA_MMAP_MERGEABLE 0x20u  /* page-align each outer slab and let KSM merge identical pages (Linux only) */
+
+/* Preallocated, prefaulted and locked memory for code that must not page fault */
+#define ANDA_MMAP_REALTIME  (ANDA_MMAP_POPULATE | ANDA_MMAP_LOCK)
+
+
+/*
+ * alloc_nd_array_mmap
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param flags: combination of ANDA_MMAP_* flags (0 for a plain lazily committed mapping)
+ * @return: pointer to the multi-dimensional array or NULL on failure
+ * @note: After calling, cast the returned pointer to the appropriate type (e.g., int***, double**, etc.) to access it as the multi-dimensional array. The memory is zero-initialized; with ANDA_MMAP_POPULATE the kernel zeroes each page while prefaulting it, so no separate clearing pass is made. Failing to lock the pages, to create the memfd or to register with KSM does not fail the allocation; check get_nd_array_mmap_flags to see whether ANDA_MMAP_LOCK, ANDA_MMAP_MEMFD or ANDA_MMAP_MERGEABLE took effect. With ANDA_MMAP_MERGEABLE the outer slabs are padded to whole pages, so the data is not contiguous across slabs and functions that depend on the standard layout (clone_nd_array, rebase_nd_array and the like) must not be used. KSM only merges private pages, so ANDA_MMAP_MERGEABLE has no effect together with ANDA_MMAP_MEMFD.
+ */
+extern void* alloc_nd_array_mmap (const size_t sizes[], size_t dims, size_t elem_size, unsigned int flags);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_nd_array_mmap_t
+ */
+#define alloc_nd_array_mmap_t(sizes, dims, elem_type, flags) \
+	alloc_nd_array_mmap((sizes), (dims), sizeof(elem_type), (flags))
+
+
+/*
+ * free_nd_array_mmap
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_mmap (NULL is ignored)
+ * @note: this function unmaps the whole mapping that holds the array (and closes its memfd, if any)
+ */
+extern void free_nd_array_mmap (void* array);
+
+
+/*
+ * get_nd_array_mmap_flags
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_mmap
+ * @return: the ANDA_MMAP_* flags that are actually in effect for the array
+ * @note: A flag requested at allocation is missing here when the system could not honor it (e.g., ANDA_MMAP_LOCK when mlock() exceeded RLIMIT_MEMLOCK).
+ */
+extern unsigned int get_nd_array_mmap_flags (const void* array);
+
+
+/*
+ * realloc_nd_array_mmap
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_mmap (NULL behaves like alloc_nd_array_mmap with no flags)
+ * @param old_sizes: sizes the array currently has (must have length equal to dims)
+ * @param new_sizes: sizes the array should have (must have length equal to dims)
+ * @param dims: number of array dimensions (must be the same as when the array was allocated)
+ * @param elem_size: size of each element in bytes (must be the same as when the array was allocated)
+ * @return: pointer to the resized multi-dimensional array or NULL on failure (in which case the original array is left untouched)
+ * @note: Snapshots cannot be resized, and an array must not be resized while snapshots of it exist.
+ * @note: Elements whose indices are valid in both shapes keep their values, and new elements are zero. When every dimension grows, the mapping is extended with mremap(), which moves page table entries instead of copying data, and the rows are then moved inside it; when every dimension shrinks, the rows are compacted and the tail pages are unmapped. Otherwise the rows are copied into a new mapping. The returned pointer may differ from array.
+ */
+extern void* realloc_nd_array_mmap (void* array, const size_t old_sizes[], const size_t new_sizes[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * realloc_nd_array_mmap_t
+ */
+#define realloc_nd_array_mmap_t(array, old_sizes, new_sizes, dims, elem_type) \
+	realloc_nd_array_mmap((array), (old_sizes), (new_sizes), (dims), sizeof(elem_type))
+
+/* Data regions at least this large are cleared by dropping their pages instead of memset() */
+#ifndef ANDA_ZERO_MADVISE_MIN_BYTES
+	#define ANDA_ZERO_MADVISE_MIN_BYTES ((size_t)2 << 20)
+#endif
+
+
+/*
+ * zero_nd_array_mmap
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_mmap
+ * @return: true if every element was set to zero, false if an error occurred
+ * @note: The pointer tables are left intact. For data regions of at least ANDA_ZERO_MADVISE_MIN_BYTES, the page-aligned interior is released with MADV_DONTNEED (or, for a memfd, by punching a hole in the file) and refaults as zero pages on the next access, so only the unaligned head and tail are cleared with memset(). Arrays allocated with ANDA_MMAP_POPULATE or ANDA_MMAP_LOCK, and snapshots, are always cleared with memset(), so that they keep their pages resident.
+ */
+extern bool zero_nd_array_mmap (void* array);
+
+
+/*
+ * snapshot_nd_array_mmap
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_mmap with ANDA_MMAP_MEMFD (not a snapshot)
+ * @return: pointer to the snapshot, a multi-dimensional array with the same shape and contents, or NULL on failure
+ * @note: The snapshot maps the memfd of array privately at a new address, and only its pointer tables are rebased (and thereby copied). Writes to the snapshot copy the affected pages and never reach array. Pages the snapshot has not written still show the contents of array, so array must not be written (or resized) while its snapshots are in use: keep it as the checkpoint and work on the snapshot, discarding the snapshot to roll back. The snapshot must be released with free_nd_array_mmap.
+ */
+extern void* snapshot_nd_array_mmap (const void* array);
+
+
+typedef struct {
+	size_t merging_pages;   /* pages of the process currently merged by KSM */
+	size_t zero_pages;      /* pages merged into the shared zero page */
+	size_t saved_bytes;     /* memory saved by merging: (merging_pages + zero_pages) * page size */
+	ptrdiff_t profit_bytes; /* saved_bytes minus the metadata KSM keeps for the process (negative when merging does not pay off) */
+} ndArrayKsmStats;
+
+
+/*
+ * get_nd_array_ksm_stats
+ * @param result_stats: pointer to store the statistics
+ * @return: true if the statistics were stored, false if an error occurred (e.g., the kernel does not provide them)
+ * @note: The statistics cover the whole process, not a single array. They are read from /proc/self/ksm_stat, or summed from the KSM entries of /proc/self/smaps on kernels without it (in which case zero_pages is 0 and profit_bytes equals saved_bytes). Merging is done in the background by ksmd, which must be enabled in /sys/kernel/mm/ksm/run.
+ */
+extern bool get_nd_array_ksm_stats (ndArrayKsmStats* result_stats);
+
+/*
+ * Releasing a very large block makes the calling thread pay for munmap() and the TLB
+ * shootdowns that come with it. The functions below hand such blocks to a background
+ * reclaimer thread instead. While the reclaimer is not running, the deferred variants
+ * simply release the block immediately.
+ */
+
+
+/* Flags for start_nd_array_reclaimer */
+#define ANDA_RECLAIM_MADV_FREE  0x01u  /* mark each batch MADV_FREE before unmapping it, so its pages become reclaimable at once */
+
+/* Blocks smaller than this (when their size is known) are released on the calling thread */
+#ifndef ANDA_RECLAIM_MIN_BYTES
+	#define ANDA_RECLAIM_MIN_BYTES ((size_t)1 << 20)
+#endif
+
+
+typedef struct {
+	size_t queued_blocks;    /* blocks waiting for (or undergoing) release */
+	size_t queued_bytes;     /* bytes of those blocks (0 for heap blocks whose size is unknown) */
+	size_t released_blocks;  /* blocks released by the reclaimer so far */
+	size_t released_bytes;   /* bytes released by the reclaimer so far */
+} ndArrayReclaimStats;
+
+
+/*
+ * start_nd_array_reclaimer
+ * @param flags: combination of ANDA_RECLAIM_* flags
+ * @return: true if the reclaimer is running (including when it was already running), false on failure
+ */
+extern bool start_nd_array_reclaimer (unsigned int flags);
+
+
+/*
+ * free_nd_array_deferred
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array or calloc_nd_array (NULL is ignored)
+ * @note: The block is handed to the reclaimer, which calls free() on it. A small bookkeeping node is allocated from the heap; if that fails, the block is freed immediately.
+ */
+extern void free_nd_array_deferred (void* array);
+
+
+/*
+ * free_nd_array_mmap_deferred
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_mmap (NULL is ignored)
+ * @note: The block is handed to the reclaimer, which unmaps it. No heap memory is used, because the bookkeeping is stored in the dead block itself.
+ */
+extern void free_nd_array_mmap_deferred (void* array);
+
+
+/*
+ * flush_nd_array_reclaimer
+ * @note: this function blocks until every block handed to the reclaimer so far has been released
+ */
+extern void flush_nd_array_reclaimer (void);
+
+
+/*
+ * stop_nd_array_reclaimer
+ * @note: This function releases all queued blocks and then terminates the reclaimer thread. Call it before the program exits.
+ */
+extern void stop_nd_array_reclaimer (void);
+
+
+/*
+ * get_nd_array_reclaim_stats
+ * @param result_stats: pointer to store the statistics
+ * @return: true if the statistics were stored, false if an error occurred
+ */
+extern bool get_nd_array_reclaim_stats (ndArrayReclaimStats* result_stats);
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
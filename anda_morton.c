@@ -0,0 +1,200 @@
+/*
+ * anda_morton.c -- implementation of multi-dimensional arrays stored in Morton (Z-order)
+ *                  order
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+
+#include "anda_morton.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "cver_compat.h"
+
+
+#define MORTON_DATA_ALIGN 64  /* データ部分の先頭をキャッシュライン境界に揃える */
+#define MORTON_MAX_BITS 63    /* 位置を uint64_t で表し、要素数 2^bits も溢れないようにする */
+
+
+static ndArrayMorton* alloc_morton_impl (const size_t sizes[], size_t dims, size_t elem_size, bool zero_fill) {
+	if (sizes == PTR_NULL || dims == 0 || dims > ANDA_MORTON_MAX_DIMS || elem_size == 0) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	/* 各次元を2のべき乗に切り上げた時のビット数を求める */
+	unsigned int bits[ANDA_MORTON_MAX_DIMS] = { 0 };
+	unsigned int total_bits = 0, max_bits = 0;
+	for (size_t d = 0; d < dims; d++) {
+		if (sizes[d] == 0) {
+			errno = EINVAL;
+			return PTR_NULL;
+		}
+		while (bits[d] < MORTON_MAX_BITS && ((uint64_t)1 << bits[d]) < (uint64_t)sizes[d]) bits[d]++;
+		total_bits += bits[d];
+		if (bits[d] > max_bits) max_bits = bits[d];
+	}
+
+	size_t header_size = anda_align_up(sizeof(ndArrayMorton), MORTON_DATA_ALIGN) + MORTON_DATA_ALIGN;  /* malloc の返すアラインメントの不足分を含む */
+	if (total_bits > MORTON_MAX_BITS || ((uint64_t)1 << total_bits) > (uint64_t)((SIZE_MAX - header_size) / elem_size)) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+	size_t total_elements = (size_t)1 << total_bits;
+
+	/* 下位ビットから各次元に1ビットずつ割り当て (最後の次元が最下位)、ビットを使い切った次元は飛ばす */
+	uint64_t masks[ANDA_MORTON_MAX_DIMS] = { 0 };
+	unsigned int pos = 0;
+	for (unsigned int level = 0; level < max_bits; level++) {
+		for (size_t d = dims; d-- > 0;) {
+			if (level < bits[d]) masks[d] |= (uint64_t)1 << pos++;
+		}
+	}
+
+	char* block = zero_fill ? calloc(1, header_size + (total_elements * elem_size)) : malloc(header_size + (total_elements * elem_size));
+	if (UNLIKELY(block == PTR_NULL)) {
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+
+	ndArrayMorton* morton = (ndArrayMorton*)(void*)block;
+	uintptr_t data = ((uintptr_t)block + sizeof(ndArrayMorton) + (MORTON_DATA_ALIGN - 1)) & ~(uintptr_t)(MORTON_DATA_ALIGN - 1);
+	morton->data = block + (data - (uintptr_t)block);
+	morton->dims = dims;
+	morton->elem_size = elem_size;
+	morton->square = (dims > 1);
+	for (size_t d = 0; d < ANDA_MORTON_MAX_DIMS; d++) {
+		morton->sizes[d] = (d < dims) ? sizes[d] : 0;
+		morton->bits[d] = bits[d];
+		morton->masks[d] = masks[d];
+		if (d < dims && bits[d] != bits[0]) morton->square = false;
+	}
+	morton->total_elements = total_elements;
+
+	return morton;
+}
+
+
+ndArrayMorton* alloc_nd_array_morton (const size_t sizes[], size_t dims, size_t elem_size) {
+	ndArrayMorton* ptr = alloc_morton_impl(sizes, dims, elem_size, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_nd_array_morton";
+	return ptr;
+}
+
+
+ndArrayMorton* calloc_nd_array_morton (const size_t sizes[], size_t dims, size_t elem_size) {
+	ndArrayMorton* ptr = alloc_morton_impl(sizes, dims, elem_size, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_nd_array_morton";
+	return ptr;
+}
+
+
+bool get_nd_array_morton_coords (const ndArrayMorton* morton, size_t index, size_t result_coords[]) {
+	if (UNLIKELY(morton == PTR_NULL || result_coords == PTR_NULL || index >= morton->total_elements)) {
+		errno = EINVAL;
+		anda_errfunc = "get_nd_array_morton_coords";
+		return false;
+	}
+
+	for (size_t d = 0; d < morton->dims; d++) {
+		result_coords[d] = (size_t)anda_pext_u64(index, morton->masks[d]);
+	}
+	return true;
+}
+
+
+/*
+ * 行優先の配列のデータ部分と Morton 配置のデータの間でコピーする (to_morton なら src が行優先、dst が
+ * Morton 配置、そうでなければ逆)。最下位の次元の位置はマスク付きの加算で進める
+ */
+static void convert_morton (const ndArrayMorton* morton, const char* src, char* dst, bool to_morton) {
+	size_t dims = morton->dims;
+	size_t elem_size = morton->elem_size;
+	size_t row_length = morton->sizes[dims - 1];
+	uint64_t inner_mask = morton->masks[dims - 1];
+	size_t rows = 1;
+	for (size_t d = 0; d + 1 < dims; d++) rows *= morton->sizes[d];
+
+	size_t flat = 0;
+	for (size_t r = 0; r < rows; r++) {
+		/* 行番号を外側の次元の添字に分解して、行の先頭の位置を求める */
+		uint64_t base = 0;
+		size_t rest = r;
+		for (size_t d = dims - 1; d-- > 0;) {
+			base |= anda_pdep_u64(rest % morton->sizes[d], morton->masks[d]);
+			rest /= morton->sizes[d];
+		}
+
+		uint64_t inner = 0;
+		for (size_t k = 0; k < row_length; k++) {
+			size_t pos = (size_t)(base | inner);
+			size_t src_index = to_morton ? flat : pos;
+			size_t dst_index = to_morton ? pos : flat;
+			memcpy(dst + (dst_index * elem_size), src + (src_index * elem_size), elem_size);
+			flat++;
+			inner = ((inner | ~inner_mask) + 1) & inner_mask;
+		}
+	}
+}
+
+
+/* alloc_nd_array と同じ配置の配列の、先頭からデータ部分までのオフセットを求める */
+static bool flat_data_offset (const ndArrayMorton* morton, size_t* result) {
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_nd_array_size(morton->sizes, morton->dims, morton->elem_size, &size_ptrs, &size_padding, &total_elements)) return false;
+	*result = size_ptrs + size_padding;
+	return true;
+}
+
+
+bool copy_nd_array_to_morton (ndArrayMorton* dst, const void* src) {
+	size_t offset;
+	if (dst == PTR_NULL || src == PTR_NULL || !flat_data_offset(dst, &offset)) {
+		errno = EINVAL;
+		anda_errfunc = "copy_nd_array_to_morton";
+		return false;
+	}
+
+	convert_morton(dst, (const char*)src + offset, dst->data, true);
+	return true;
+}
+
+
+bool copy_morton_to_nd_array (void* dst, const ndArrayMorton* src) {
+	size_t offset;
+	if (dst == PTR_NULL || src == PTR_NULL || !flat_data_offset(src, &offset)) {
+		errno = EINVAL;
+		anda_errfunc = "copy_morton_to_nd_array";
+		return false;
+	}
+
+	convert_morton(src, src->data, (char*)dst + offset, false);
+	return true;
+}
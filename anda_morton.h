@@ -0,0 +1,285 @@
+/*
+ * anda_morton.h -- interface for multi-dimensional arrays stored in Morton (Z-order)
+ *                  order
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#pragma once
+
+#ifndef ANDA_MORTON_H
+#define ANDA_MORTON_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(__BMI2__) && (defined(__x86_64__) || defined(_M_X64))
+	#include <immintrin.h>
+#endif
+
+
+
+/*
+ * A Morton array stores its elements in Z-order: the position of an element is
+ * obtained by interleaving the bits of its indices, so elements that are close in
+ * every dimension are close in memory at every scale. This suits quadtree/octree
+ * traversals and accesses to random neighbourhoods.
+ *
+ * Each dimension is padded up to a power of two. When the padded sizes differ, the
+ * bits of the longer dimensions that have no counterpart are placed above the
+ * interleaved ones, so only the padding to powers of two is wasted. The position of
+ * element (i, j) is pdep(i, masks[0]) | pdep(j, masks[1]); with BMI2 (compile with
+ * -mbmi2 or -march=haswell or later) this is a pair of pdep instructions, and
+ * otherwise a portable bit-spreading fallback is used.
+ *
+ * Like a tiled array, a Morton array is described by an ndArrayMorton header stored
+ * at the start of the same block as its data, and it is freed with a single free().
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+#define ANDA_MORTON_MAX_DIMS 3
+
+#if defined(__BMI2__) && (defined(__x86_64__) || defined(_M_X64))
+	#define ANDA_MORTON_BMI2
+#endif
+
+
+typedef struct {
+	void* data;                                /* element at Morton position 0 (aligned to 64 bytes) */
+	size_t dims;                               /* number of dimensions (1 to ANDA_MORTON_MAX_DIMS) */
+	size_t elem_size;                          /* size of each element in bytes */
+	size_t sizes[ANDA_MORTON_MAX_DIMS];        /* logical size of each dimension */
+	unsigned int bits[ANDA_MORTON_MAX_DIMS];   /* number of index bits of each dimension (log2 of the padded size) */
+	uint64_t masks[ANDA_MORTON_MAX_DIMS];      /* positions of the index bits of each dimension */
+	size_t total_elements;                     /* number of elements including the padding */
+	bool square;                               /* every dimension has the same number of bits */
+} ndArrayMorton;
+
+
+/*
+ * anda_pdep_u64 / anda_pext_u64
+ * Parallel bit deposit and extract: pdep scatters the low bits of src to the positions
+ * of the set bits of mask, and pext gathers them back.
+ */
+static inline uint64_t anda_pdep_u64 (uint64_t src, uint64_t mask) {
+#ifdef ANDA_MORTON_BMI2
+	return (uint64_t)_pdep_u64(src, mask);
+#else
+	uint64_t result = 0;
+	for (uint64_t bit = 1; mask != 0; bit <<= 1) {
+		if ((src & bit) != 0) result |= mask & (~mask + 1);
+		mask &= mask - 1;
+	}
+	return result;
+#endif
+}
+
+
+static inline uint64_t anda_pext_u64 (uint64_t src, uint64_t mask) {
+#ifdef ANDA_MORTON_BMI2
+	return (uint64_t)_pext_u64(src, mask);
+#else
+	uint64_t result = 0;
+	for (uint64_t bit = 1; mask != 0; bit <<= 1) {
+		if ((src & mask & (~mask + 1)) != 0) result |= bit;
+		mask &= mask - 1;
+	}
+	return result;
+#endif
+}
+
+
+/*
+ * encode_morton_2d / encode_morton_3d
+ * Morton codes of square (2D, up to 32 bits per index) and cubic (3D, up to 21 bits per
+ * index) shapes, computed with the classic magic-number bit spreading.
+ */
+static inline uint64_t anda_morton_spread2 (uint64_t x) {
+	x &= 0xFFFFFFFFu;
+	x = (x | (x << 16)) & UINT64_C(0x0000FFFF0000FFFF);
+	x = (x | (x << 8)) & UINT64_C(0x00FF00FF00FF00FF);
+	x = (x | (x << 4)) & UINT64_C(0x0F0F0F0F0F0F0F0F);
+	x = (x | (x << 2)) & UINT64_C(0x3333333333333333);
+	x = (x | (x << 1)) & UINT64_C(0x5555555555555555);
+	return x;
+}
+
+
+static inline uint64_t anda_morton_spread3 (uint64_t x) {
+	x &= 0x1FFFFFu;
+	x = (x | (x << 32)) & UINT64_C(0x001F00000000FFFF);
+	x = (x | (x << 16)) & UINT64_C(0x001F0000FF0000FF);
+	x = (x | (x << 8)) & UINT64_C(0x100F00F00F00F00F);
+	x = (x | (x << 4)) & UINT64_C(0x10C30C30C30C30C3);
+	x = (x | (x << 2)) & UINT64_C(0x1249249249249249);
+	return x;
+}
+
+
+static inline uint64_t encode_morton_2d (uint64_t i, uint64_t j) {
+	return (anda_morton_spread2(i) << 1) | anda_morton_spread2(j);
+}
+
+
+static inline uint64_t encode_morton_3d (uint64_t i, uint64_t j, uint64_t k) {
+	return (anda_morton_spread3(i) << 2) | (anda_morton_spread3(j) << 1) | anda_morton_spread3(k);
+}
+
+
+/*
+ * get_nd_array_morton_index_2d
+ * @param morton: pointer to a 2D Morton array
+ * @param i: row index
+ * @param j: column index
+ * @return: position of element (i, j) in morton->data, in elements
+ */
+static inline size_t get_nd_array_morton_index_2d (const ndArrayMorton* morton, size_t i, size_t j) {
+#ifndef ANDA_MORTON_BMI2
+	if (morton->square) return (size_t)encode_morton_2d(i, j);
+#endif
+	return (size_t)(anda_pdep_u64(i, morton->masks[0]) | anda_pdep_u64(j, morton->masks[1]));
+}
+
+
+/*
+ * get_nd_array_morton_index_3d
+ * @param morton: pointer to a 3D Morton array
+ * @param i: index along the first dimension
+ * @param j: index along the second dimension
+ * @param k: index along the third dimension
+ * @return: position of element (i, j, k) in morton->data, in elements
+ */
+static inline size_t get_nd_array_morton_index_3d (const ndArrayMorton* morton, size_t i, size_t j, size_t k) {
+#ifndef ANDA_MORTON_BMI2
+	if (morton->square) return (size_t)encode_morton_3d(i, j, k);
+#endif
+	return (size_t)(anda_pdep_u64(i, morton->masks[0]) | anda_pdep_u64(j, morton->masks[1]) | anda_pdep_u64(k, morton->masks[2]));
+}
+
+
+/* Element accessors (usable as lvalues), e.g. ANDA_MORTON_AT_2D(m, float, i, j) = 1.0f; */
+#define ANDA_MORTON_AT_2D(morton, elem_type, i, j) \
+	(((elem_type*)(morton)->data)[get_nd_array_morton_index_2d((morton), (i), (j))])
+
+#define ANDA_MORTON_AT_3D(morton, elem_type, i, j, k) \
+	(((elem_type*)(morton)->data)[get_nd_array_morton_index_3d((morton), (i), (j), (k))])
+
+
+/*
+ * alloc_nd_array_morton
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (1 to ANDA_MORTON_MAX_DIMS)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the Morton array or NULL on failure
+ * @note: Every dimension is padded up to a power of two. The elements, including the padding, are uninitialized. The allocated memory must be freed using free() when no longer needed.
+ */
+extern ndArrayMorton* alloc_nd_array_morton (const size_t sizes[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_nd_array_morton_t
+ */
+#define alloc_nd_array_morton_t(sizes, dims, elem_type) \
+	alloc_nd_array_morton((sizes), (dims), sizeof(elem_type))
+
+
+/*
+ * calloc_nd_array_morton
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (1 to ANDA_MORTON_MAX_DIMS)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the Morton array or NULL on failure
+ * @note: Same as alloc_nd_array_morton, except that every element, including the padding, is set to zero.
+ */
+extern ndArrayMorton* calloc_nd_array_morton (const size_t sizes[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_nd_array_morton_t
+ */
+#define calloc_nd_array_morton_t(sizes, dims, elem_type) \
+	calloc_nd_array_morton((sizes), (dims), sizeof(elem_type))
+
+
+/*
+ * get_nd_array_morton_coords
+ * @param morton: pointer to the Morton array
+ * @param index: position in morton->data, in elements (below morton->total_elements)
+ * @param result_coords: array of morton->dims elements to store the indices of the element
+ * @return: true if the indices were stored, false if an error occurred
+ * @note: Positions in the padding yield indices at or beyond the logical sizes.
+ */
+extern bool get_nd_array_morton_coords (const ndArrayMorton* morton, size_t index, size_t result_coords[]);
+
+
+/*
+ * copy_nd_array_to_morton
+ * @param dst: pointer to the Morton array that receives the elements
+ * @param src: pointer to a multi-dimensional array allocated by alloc_nd_array or calloc_nd_array with the same sizes and element size
+ * @return: true if the elements were copied, false if an error occurred
+ * @note: The rows of src are read sequentially while the Morton positions are advanced with a masked increment, so no per-element encoding is needed. The padding of dst is left untouched.
+ */
+extern bool copy_nd_array_to_morton (ndArrayMorton* dst, const void* src);
+
+
+/*
+ * copy_morton_to_nd_array
+ * @param dst: pointer to a multi-dimensional array allocated by alloc_nd_array or calloc_nd_array with the same sizes and element size
+ * @param src: pointer to the Morton array to copy from
+ * @return: true if the elements were copied, false if an error occurred
+ */
+extern bool copy_morton_to_nd_array (void* dst, const ndArrayMorton* src);
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
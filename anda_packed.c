@@ -0,0 +1,197 @@
+/*
+ * anda_packed.c -- implementation of packed storage of structured matrices
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+
+#include "anda_packed.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include "cver_compat.h"
+
+
+/* ポインタ nptrs 個、要素 nelems 個を収めるブロックを確保し、データ部分の先頭を result_data に格納する */
+static void* alloc_packed_block (size_t nptrs, size_t nelems, size_t elem_size, bool zero_fill, char** result_data) {
+	if (elem_size == 0 || nptrs > (SIZE_MAX / sizeof(void*))) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+	size_t size_ptrs = nptrs * sizeof(void*);
+
+	/* アラインメント違反を防ぐため必要に応じて切り上げ */
+	size_t size_padding = 0;
+	if (elem_size > sizeof(void*)) {
+		size_t size_ptrs_max = anda_align_up(size_ptrs, elem_size);
+		if (size_ptrs_max == 0) {
+			errno = EINVAL;
+			return PTR_NULL;
+		}
+		size_padding = size_ptrs_max - size_ptrs;
+	}
+
+	if ((nelems > (SIZE_MAX / elem_size)) ||
+	   ((nelems * elem_size) > (SIZE_MAX - size_ptrs - size_padding))) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	size_t size = size_ptrs + size_padding + (nelems * elem_size);
+	char* block = zero_fill ? calloc(1, size) : malloc(size);
+	if (UNLIKELY(block == PTR_NULL)) {
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+
+	*result_data = block + size_ptrs + size_padding;
+	return block;
+}
+
+
+/* n * (n + 1) / 2 を溢れないように求める */
+static bool triangle_elements (size_t n, size_t* result) {
+	if (n == SIZE_MAX) return false;
+
+	size_t a = n, b = n + 1;
+	if ((a % 2) == 0) a /= 2;
+	else b /= 2;
+
+	if (a != 0 && b > SIZE_MAX / a) return false;
+	*result = a * b;
+	return true;
+}
+
+
+/* 三角行列1つ分の行ポインタを書き込む (上三角は行の先頭が i 列目に来るように i 要素分手前を指す) */
+static void link_triangle_rows (void** rows, char* data, size_t n, size_t elem_size, unsigned int triangle) {
+	size_t offset = 0;
+	for (size_t i = 0; i < n; i++) {
+		if (triangle == ANDA_TRIANGULAR_UPPER) {
+			rows[i] = data + ((offset - i) * elem_size);
+			offset += n - i;
+		} else {
+			rows[i] = data + (offset * elem_size);
+			offset += i + 1;
+		}
+	}
+}
+
+
+static void* alloc_triangular_impl (size_t count, size_t n, size_t elem_size, unsigned int triangle, bool batched, bool zero_fill) {
+	size_t per_matrix;
+	if (count == 0 || n == 0 || (triangle != ANDA_TRIANGULAR_LOWER && triangle != ANDA_TRIANGULAR_UPPER) ||
+		!triangle_elements(n, &per_matrix) || n > (SIZE_MAX - count) / count || per_matrix > SIZE_MAX / count) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	/* 一括確保の場合は行列ごとのポインタ count 個を行ポインタの前に置く */
+	size_t ntops = batched ? count : 0;
+	char* data;
+	void** block = alloc_packed_block(ntops + (count * n), count * per_matrix, elem_size, zero_fill, &data);
+	if (block == PTR_NULL) return PTR_NULL;
+
+	void** rows = block + ntops;
+	for (size_t k = 0; k < count; k++) {
+		if (batched) block[k] = rows + (k * n);
+		link_triangle_rows(rows + (k * n), data + (k * per_matrix * elem_size), n, elem_size, triangle);
+	}
+
+	return block;
+}
+
+
+void* alloc_triangular_array (size_t n, size_t elem_size, unsigned int triangle) {
+	void* ptr = alloc_triangular_impl(1, n, elem_size, triangle, false, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_triangular_array";
+	return ptr;
+}
+
+
+void* calloc_triangular_array (size_t n, size_t elem_size, unsigned int triangle) {
+	void* ptr = alloc_triangular_impl(1, n, elem_size, triangle, false, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_triangular_array";
+	return ptr;
+}
+
+
+void* alloc_triangular_array_batch (size_t count, size_t n, size_t elem_size, unsigned int triangle) {
+	void* ptr = alloc_triangular_impl(count, n, elem_size, triangle, true, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_triangular_array_batch";
+	return ptr;
+}
+
+
+void* calloc_triangular_array_batch (size_t count, size_t n, size_t elem_size, unsigned int triangle) {
+	void* ptr = alloc_triangular_impl(count, n, elem_size, triangle, true, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_triangular_array_batch";
+	return ptr;
+}
+
+
+static void* alloc_banded_impl (size_t n, size_t lower_bw, size_t upper_bw, size_t elem_size, bool zero_fill) {
+	if (n == 0) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	/* 行列の外にはみ出す帯幅は意味を持たないので切り詰める */
+	if (lower_bw > n - 1) lower_bw = n - 1;
+	if (upper_bw > n - 1) upper_bw = n - 1;
+	size_t width = lower_bw + upper_bw + 1;  /* 1行あたりの格納数 (2n - 1 を超えない) */
+	if (width > SIZE_MAX / n) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	char* data;
+	void** rows = alloc_packed_block(n, n * width, elem_size, zero_fill, &data);
+	if (rows == PTR_NULL) return PTR_NULL;
+
+	/* 行 i の格納域は i - lower_bw 列目から始まるので、i 列目が i * width + lower_bw 番目に来るようにずらす */
+	for (size_t i = 0; i < n; i++) {
+		rows[i] = data + (((i * (width - 1)) + lower_bw) * elem_size);
+	}
+
+	return rows;
+}
+
+
+void* alloc_banded_array (size_t n, size_t lower_bw, size_t upper_bw, size_t elem_size) {
+	void* ptr = alloc_banded_impl(n, lower_bw, upper_bw, elem_size, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_banded_array";
+	return ptr;
+}
+
+
+void* calloc_banded_array (size_t n, size_t lower_bw, size_t upper_bw, size_t elem_size) {
+	void* ptr = alloc_banded_impl(n, lower_bw, upper_bw, elem_size, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_banded_array";
+	return ptr;
+}
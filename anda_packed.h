@@ -0,0 +1,204 @@
+/*
+ * anda_packed.h -- interface for packed storage of structured matrices
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#pragma once
+
+#ifndef ANDA_PACKED_H
+#define ANDA_PACKED_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * The matrices in this header store only the elements their structure allows, packed
+ * row after row, yet they are indexed as a[i][j] with the original row and column
+ * numbers: each row pointer is pre-offset so that the stored part of the row appears
+ * at its true columns. Like alloc_nd_array, every matrix occupies a single block that
+ * is freed with one free() (or free_nd_array).
+ *
+ * Accessing an element outside the stored part (e.g., a[i][j] with j > i in a lower
+ * triangular matrix) is undefined behavior, just like any other out-of-range index.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+/* Triangles for alloc_triangular_array */
+#define ANDA_TRIANGULAR_LOWER  0u  /* row i stores columns 0 to i */
+#define ANDA_TRIANGULAR_UPPER  1u  /* row i stores columns i to n - 1 */
+
+
+/*
+ * Element (i, j) of a symmetric matrix stored as a lower (or upper) triangular array,
+ * for any i and j. The arguments are evaluated more than once.
+ */
+#define ANDA_SYM_LOWER(a, i, j)  (((i) >= (j)) ? (a)[(i)][(j)] : (a)[(j)][(i)])
+#define ANDA_SYM_UPPER(a, i, j)  (((i) <= (j)) ? (a)[(i)][(j)] : (a)[(j)][(i)])
+
+
+/*
+ * alloc_triangular_array
+ * @param n: number of rows and columns
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param triangle: ANDA_TRIANGULAR_LOWER or ANDA_TRIANGULAR_UPPER
+ * @return: pointer to the triangular matrix (cast it to e.g. double**) or NULL on failure
+ * @note: Only n * (n + 1) / 2 elements are stored. a[i][j] is valid for j <= i in a lower matrix and for j >= i in an upper one; use ANDA_SYM_LOWER or ANDA_SYM_UPPER to read a symmetric matrix at any position. For a symmetric matrix, the data of a lower array is the packed storage LAPACK uses with UPLO='U', and that of an upper array the one with UPLO='L'. The allocated memory must be freed using free() when no longer needed. The returned memory is uninitialized.
+ */
+extern void* alloc_triangular_array (size_t n, size_t elem_size, unsigned int triangle);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_triangular_array_t
+ */
+#define alloc_triangular_array_t(n, elem_type, triangle) \
+	alloc_triangular_array((n), sizeof(elem_type), (triangle))
+
+
+/*
+ * calloc_triangular_array
+ * @param n: number of rows and columns
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param triangle: ANDA_TRIANGULAR_LOWER or ANDA_TRIANGULAR_UPPER
+ * @return: pointer to the triangular matrix (cast it to e.g. double**) or NULL on failure
+ * @note: Same as alloc_triangular_array, except that the elements are set to zero.
+ */
+extern void* calloc_triangular_array (size_t n, size_t elem_size, unsigned int triangle);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_triangular_array_t
+ */
+#define calloc_triangular_array_t(n, elem_type, triangle) \
+	calloc_triangular_array((n), sizeof(elem_type), (triangle))
+
+
+/*
+ * alloc_triangular_array_batch
+ * @param count: number of matrices
+ * @param n: number of rows and columns of each matrix
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param triangle: ANDA_TRIANGULAR_LOWER or ANDA_TRIANGULAR_UPPER
+ * @return: pointer to the batch (cast it to e.g. double***, then index it as a[k][i][j]) or NULL on failure
+ * @note: The packed matrices follow one another in a single data region, for count * n * (n + 1) / 2 elements in total. The allocated memory must be freed using free() when no longer needed. The returned memory is uninitialized.
+ */
+extern void* alloc_triangular_array_batch (size_t count, size_t n, size_t elem_size, unsigned int triangle);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_triangular_array_batch_t
+ */
+#define alloc_triangular_array_batch_t(count, n, elem_type, triangle) \
+	alloc_triangular_array_batch((count), (n), sizeof(elem_type), (triangle))
+
+
+/*
+ * calloc_triangular_array_batch
+ * @param count: number of matrices
+ * @param n: number of rows and columns of each matrix
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param triangle: ANDA_TRIANGULAR_LOWER or ANDA_TRIANGULAR_UPPER
+ * @return: pointer to the batch (cast it to e.g. double***, then index it as a[k][i][j]) or NULL on failure
+ * @note: Same as alloc_triangular_array_batch, except that the elements are set to zero.
+ */
+extern void* calloc_triangular_array_batch (size_t count, size_t n, size_t elem_size, unsigned int triangle);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_triangular_array_batch_t
+ */
+#define calloc_triangular_array_batch_t(count, n, elem_type, triangle) \
+	calloc_triangular_array_batch((count), (n), sizeof(elem_type), (triangle))
+
+
+/*
+ * alloc_banded_array
+ * @param n: number of rows and columns
+ * @param lower_bw: number of diagonals stored below the main diagonal (values of n or more are reduced to n - 1)
+ * @param upper_bw: number of diagonals stored above the main diagonal (values of n or more are reduced to n - 1)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the banded matrix (cast it to e.g. double**) or NULL on failure
+ * @note: a[i][j] is valid exactly when -lower_bw <= j - i <= upper_bw (and 0 <= j < n). Every row stores lower_bw + upper_bw + 1 elements, for n * (lower_bw + upper_bw + 1) in total; the slots of the first and last rows that fall outside the matrix are allocated but never addressed, as in LAPACK band storage. The rows are contiguous, so the data is the row-major counterpart of the LAPACK band layout. The allocated memory must be freed using free() when no longer needed. The returned memory is uninitialized.
+ */
+extern void* alloc_banded_array (size_t n, size_t lower_bw, size_t upper_bw, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_banded_array_t
+ */
+#define alloc_banded_array_t(n, lower_bw, upper_bw, elem_type) \
+	alloc_banded_array((n), (lower_bw), (upper_bw), sizeof(elem_type))
+
+
+/*
+ * calloc_banded_array
+ * @param n: number of rows and columns
+ * @param lower_bw: number of diagonals stored below the main diagonal (values of n or more are reduced to n - 1)
+ * @param upper_bw: number of diagonals stored above the main diagonal (values of n or more are reduced to n - 1)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the banded matrix (cast it to e.g. double**) or NULL on failure
+ * @note: Same as alloc_banded_array, except that the elements are set to zero.
+ */
+extern void* calloc_banded_array (size_t n, size_t lower_bw, size_t upper_bw, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_banded_array_t
+ */
+#define calloc_banded_array_t(n, lower_bw, upper_bw, elem_type) \
+	calloc_banded_array((n), (lower_bw), (upper_bw), sizeof(elem_type))
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
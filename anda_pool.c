@@ -0,0 +1,383 @@
+/*
+ * anda_pool.c -- implementation of a bounded pool of preallocated multi-dimensional
+ *                arrays that can be passed between threads
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+#include "anda_pool.h"
+#include "anda_llapi.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "cver_compat.h"
+
+
+#if !defined (__STDC_VERSION__) || (__STDC_VERSION__ < 201112L) || defined (__STDC_NO_ATOMICS__)
+	#error "anda_pool.c requires C11 atomics."
+#endif
+
+
+#define POOL_CACHE_LINE 64
+
+
+typedef struct {
+	_Atomic size_t seq;
+	void* array;
+} poolCell;
+
+
+struct ndArrayPool {
+	/* Vyukov 方式の有界 MPMC キュー (投入側と取り出し側の位置は別のキャッシュラインに置く) */
+	_Alignas(POOL_CACHE_LINE) _Atomic size_t enqueue_pos;
+	_Alignas(POOL_CACHE_LINE) _Atomic size_t dequeue_pos;
+
+	_Alignas(POOL_CACHE_LINE) poolCell* cells;
+	size_t mask;
+
+	char* arrays;                   /* 全配列をまとめて確保した領域 */
+	size_t stride;
+	size_t count;
+	_Atomic bool* acquired;         /* 各配列が取得中かどうか (二重返却の検出に使用) */
+
+	_Atomic size_t waiters;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+
+	/* 統計情報 */
+	_Atomic size_t in_use;
+	_Atomic size_t peak_in_use;
+	_Atomic size_t acquires;
+	_Atomic size_t releases;
+	_Atomic size_t failed_acquires;
+	_Atomic size_t waits;
+};
+
+
+/*
+ * 配列の総数はキューの容量以下なので、本当に満杯になることはない。セルが空いていないように見えるのは、
+ * 前の周回でそのセルから取り出したスレッドがまだ完了を公開していない間だけなので、公開を待って再試行する
+ */
+static void pool_enqueue (ndArrayPool* pool, void* array) {
+	size_t pos = atomic_load_explicit(&pool->enqueue_pos, memory_order_relaxed);
+	poolCell* cell;
+	for (;;) {
+		cell = &pool->cells[pos & pool->mask];
+		size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+		intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+		if (dif == 0) {
+			if (atomic_compare_exchange_weak_explicit(&pool->enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+				break;
+		} else {
+			pos = atomic_load_explicit(&pool->enqueue_pos, memory_order_relaxed);
+		}
+	}
+
+	cell->array = array;
+	atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+}
+
+
+static void* pool_dequeue (ndArrayPool* pool) {
+	size_t pos = atomic_load_explicit(&pool->dequeue_pos, memory_order_relaxed);
+	poolCell* cell;
+	for (;;) {
+		cell = &pool->cells[pos & pool->mask];
+		size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+		intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+		if (dif == 0) {
+			if (atomic_compare_exchange_weak_explicit(&pool->dequeue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+				break;
+		} else if (dif < 0) {
+			return PTR_NULL;  /* 空 */
+		} else {
+			pos = atomic_load_explicit(&pool->dequeue_pos, memory_order_relaxed);
+		}
+	}
+
+	void* array = cell->array;
+	atomic_store_explicit(&cell->seq, pos + pool->mask + 1, memory_order_release);
+	return array;
+}
+
+
+static void note_acquired (ndArrayPool* pool, void* array) {
+	atomic_store_explicit(&pool->acquired[(size_t)((char*)array - pool->arrays) / pool->stride], true, memory_order_relaxed);
+	atomic_fetch_add_explicit(&pool->acquires, 1, memory_order_relaxed);
+
+	size_t in_use = atomic_fetch_add_explicit(&pool->in_use, 1, memory_order_relaxed) + 1;
+	size_t peak = atomic_load_explicit(&pool->peak_in_use, memory_order_relaxed);
+	while (in_use > peak) {
+		if (atomic_compare_exchange_weak_explicit(&pool->peak_in_use, &peak, in_use, memory_order_relaxed, memory_order_relaxed))
+			break;
+	}
+}
+
+
+ndArrayPool* create_nd_array_pool (const size_t sizes[], size_t dims, size_t elem_size, size_t count) {
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_nd_array_size(sizes, dims, elem_size, &size_ptrs, &size_padding, &total_elements)) {
+		anda_errfunc = "create_nd_array_pool";
+		return PTR_NULL;
+	}
+
+	/* キューの容量は count 以上の2のべき乗 */
+	size_t capacity = 2;
+	while (capacity < count && capacity <= (SIZE_MAX / 2)) capacity *= 2;
+
+	size_t stride = anda_align_up(size_ptrs + size_padding + (total_elements * elem_size), POOL_CACHE_LINE);
+	if (count == 0 || capacity < count || stride == 0 || count > (SIZE_MAX / stride) ||
+		capacity > (SIZE_MAX / sizeof(poolCell))) {
+		errno = EINVAL;
+		anda_errfunc = "create_nd_array_pool";
+		return PTR_NULL;
+	}
+
+	void* memory = PTR_NULL;
+	if (posix_memalign(&memory, POOL_CACHE_LINE, sizeof(ndArrayPool)) != 0) memory = PTR_NULL;
+	ndArrayPool* pool = memory;
+	if (UNLIKELY(pool == PTR_NULL)) {
+		errno = ENOMEM;
+		anda_errfunc = "create_nd_array_pool";
+		return PTR_NULL;
+	}
+
+	void* arrays = PTR_NULL;
+	if (posix_memalign(&arrays, POOL_CACHE_LINE, count * stride) != 0) arrays = PTR_NULL;
+	pool->cells = malloc(capacity * sizeof(poolCell));
+	pool->acquired = malloc(count * sizeof(_Atomic bool));
+	if (UNLIKELY(arrays == PTR_NULL || pool->cells == PTR_NULL || pool->acquired == PTR_NULL)) {
+		free(arrays);
+		free(pool->cells);
+		free(pool->acquired);
+		free(pool);
+		errno = ENOMEM;
+		anda_errfunc = "create_nd_array_pool";
+		return PTR_NULL;
+	}
+
+	if (pthread_mutex_init(&pool->mutex, PTR_NULL) != 0) {
+		free(arrays);
+		free(pool->cells);
+		free(pool->acquired);
+		free(pool);
+		errno = ENOMEM;
+		anda_errfunc = "create_nd_array_pool";
+		return PTR_NULL;
+	}
+	if (pthread_cond_init(&pool->cond, PTR_NULL) != 0) {
+		pthread_mutex_destroy(&pool->mutex);
+		free(arrays);
+		free(pool->cells);
+		free(pool->acquired);
+		free(pool);
+		errno = ENOMEM;
+		anda_errfunc = "create_nd_array_pool";
+		return PTR_NULL;
+	}
+
+	pool->arrays = arrays;
+	pool->stride = stride;
+	pool->count = count;
+	pool->mask = capacity - 1;
+
+	atomic_init(&pool->enqueue_pos, 0);
+	atomic_init(&pool->dequeue_pos, 0);
+	atomic_init(&pool->waiters, 0);
+	atomic_init(&pool->in_use, 0);
+	atomic_init(&pool->peak_in_use, 0);
+	atomic_init(&pool->acquires, 0);
+	atomic_init(&pool->releases, 0);
+	atomic_init(&pool->failed_acquires, 0);
+	atomic_init(&pool->waits, 0);
+
+	for (size_t i = 0; i < capacity; i++) {
+		atomic_init(&pool->cells[i].seq, i);
+		pool->cells[i].array = PTR_NULL;
+	}
+
+	/* 全配列のポインタテーブルを組み立ててキューに積む */
+	for (size_t i = 0; i < count; i++) {
+		atomic_init(&pool->acquired[i], false);
+		void* array = initialize_nd_array(pool->arrays + (i * stride), sizes, dims, elem_size, size_ptrs, size_padding, total_elements);
+		pool_enqueue(pool, array);
+	}
+
+	return pool;
+}
+
+
+void* try_acquire_nd_array_pool (ndArrayPool* pool) {
+	if (UNLIKELY(pool == PTR_NULL)) {
+		errno = EINVAL;
+		anda_errfunc = "try_acquire_nd_array_pool";
+		return PTR_NULL;
+	}
+
+	void* array = pool_dequeue(pool);
+	if (array == PTR_NULL) {
+		atomic_fetch_add_explicit(&pool->failed_acquires, 1, memory_order_relaxed);
+		errno = EAGAIN;
+		anda_errfunc = "try_acquire_nd_array_pool";
+		return PTR_NULL;
+	}
+
+	note_acquired(pool, array);
+	return array;
+}
+
+
+void* acquire_nd_array_pool (ndArrayPool* pool, long timeout_ms) {
+	if (UNLIKELY(pool == PTR_NULL)) {
+		errno = EINVAL;
+		anda_errfunc = "acquire_nd_array_pool";
+		return PTR_NULL;
+	}
+
+	void* array = pool_dequeue(pool);
+	if (LIKELY(array != PTR_NULL)) {
+		note_acquired(pool, array);
+		return array;
+	}
+
+	/* 空なので待機する (待機者数を先に公開してから再確認し、取りこぼしを防ぐ) */
+	struct timespec deadline = {0, 0};
+	if (timeout_ms >= 0) {
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += (time_t)(timeout_ms / 1000);
+		deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec += 1;
+			deadline.tv_nsec -= 1000000000L;
+		}
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+	atomic_fetch_add(&pool->waiters, 1);
+	/* 待機者数の公開と再確認の読み込みの順序を保証する (返却側の対になるフェンスと合わせて取りこぼしを防ぐ) */
+	atomic_thread_fence(memory_order_seq_cst);
+	bool waited = false;
+	for (;;) {
+		array = pool_dequeue(pool);
+		if (array != PTR_NULL) break;
+
+		if (!waited) {  /* 実際に待機した取得だけを1回数える */
+			atomic_fetch_add_explicit(&pool->waits, 1, memory_order_relaxed);
+			waited = true;
+		}
+		int rc;
+		if (timeout_ms < 0) {
+			rc = pthread_cond_wait(&pool->cond, &pool->mutex);
+		} else {
+			rc = pthread_cond_timedwait(&pool->cond, &pool->mutex, &deadline);
+		}
+		if (rc == ETIMEDOUT) {
+			array = pool_dequeue(pool);
+			break;
+		}
+	}
+	atomic_fetch_sub(&pool->waiters, 1);
+	pthread_mutex_unlock(&pool->mutex);
+
+	if (array == PTR_NULL) {
+		atomic_fetch_add_explicit(&pool->failed_acquires, 1, memory_order_relaxed);
+		errno = ETIMEDOUT;
+		anda_errfunc = "acquire_nd_array_pool";
+		return PTR_NULL;
+	}
+
+	note_acquired(pool, array);
+	return array;
+}
+
+
+bool release_nd_array_pool (ndArrayPool* pool, void* array) {
+	char* slot = array;
+	if (UNLIKELY(pool == PTR_NULL || slot < pool->arrays || slot >= pool->arrays + (pool->count * pool->stride) ||
+		((size_t)(slot - pool->arrays) % pool->stride) != 0)) {
+		errno = EINVAL;
+		anda_errfunc = "release_nd_array_pool";
+		return false;
+	}
+
+	/* 取得されていない配列の返却 (二重返却など) を弾く */
+	_Atomic bool* acquired = &pool->acquired[(size_t)(slot - pool->arrays) / pool->stride];
+	if (UNLIKELY(!atomic_exchange_explicit(acquired, false, memory_order_relaxed))) {
+		errno = EINVAL;
+		anda_errfunc = "release_nd_array_pool";
+		return false;
+	}
+
+	pool_enqueue(pool, array);
+	atomic_fetch_sub_explicit(&pool->in_use, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&pool->releases, 1, memory_order_relaxed);
+
+	/*
+	 * 待機中のスレッドがいる時だけロックを取って起こす。キューへの公開 (release ストア) と待機者数の読み込みは
+	 * ストア→ロードの順序になり保証されないので、フェンスで順序付ける
+	 */
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load(&pool->waiters) != 0) {
+		pthread_mutex_lock(&pool->mutex);
+		pthread_cond_signal(&pool->cond);
+		pthread_mutex_unlock(&pool->mutex);
+	}
+	return true;
+}
+
+
+bool get_nd_array_pool_stats (ndArrayPool* pool, ndArrayPoolStats* result_stats) {
+	if (pool == PTR_NULL || result_stats == PTR_NULL) {
+		errno = EINVAL;
+		anda_errfunc = "get_nd_array_pool_stats";
+		return false;
+	}
+
+	result_stats->capacity = pool->count;
+	result_stats->in_use = atomic_load_explicit(&pool->in_use, memory_order_relaxed);
+	result_stats->peak_in_use = atomic_load_explicit(&pool->peak_in_use, memory_order_relaxed);
+	result_stats->acquires = atomic_load_explicit(&pool->acquires, memory_order_relaxed);
+	result_stats->releases = atomic_load_explicit(&pool->releases, memory_order_relaxed);
+	result_stats->failed_acquires = atomic_load_explicit(&pool->failed_acquires, memory_order_relaxed);
+	result_stats->waits = atomic_load_explicit(&pool->waits, memory_order_relaxed);
+	return true;
+}
+
+
+void destroy_nd_array_pool (ndArrayPool* pool) {
+	if (pool == PTR_NULL) return;
+
+	pthread_cond_destroy(&pool->cond);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool->cells);
+	free(pool->acquired);
+	free(pool->arrays);
+	free(pool);
+}
@@ -0,0 +1,156 @@
+/*
+ * anda_pool.h -- interface of a bounded pool of preallocated multi-dimensional arrays
+ *                that can be passed between threads
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+#pragma once
+
+#ifndef ANDA_POOL_H
+#define ANDA_POOL_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * A pool holds a fixed number of same-shape arrays that are all allocated when the
+ * pool is created. Arrays are handed out and taken back through a lock-free bounded
+ * MPMC queue, so any thread may acquire an array and any other thread may release it
+ * without touching the heap.
+ *
+ * When the pool is empty, acquire_nd_array_pool blocks until another thread releases
+ * an array (or the timeout expires), which gives producers natural back-pressure.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+typedef struct ndArrayPool ndArrayPool;
+
+typedef struct {
+	size_t capacity;         /* number of arrays owned by the pool */
+	size_t in_use;           /* number of arrays currently acquired */
+	size_t peak_in_use;      /* highest value in_use has reached */
+	size_t acquires;         /* successful acquisitions */
+	size_t releases;         /* successful releases */
+	size_t failed_acquires;  /* acquisitions that found the pool empty and gave up (including timeouts) */
+	size_t waits;            /* acquisitions that had to block */
+} ndArrayPoolStats;
+
+
+/*
+ * create_nd_array_pool
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param count: number of arrays held by the pool
+ * @return: pointer to the pool or NULL on failure
+ * @note: Every array is allocated here, each starting on its own cache line. The contents of the arrays are uninitialized. The pool must be released with destroy_nd_array_pool.
+ */
+extern ndArrayPool* create_nd_array_pool (const size_t sizes[], size_t dims, size_t elem_size, size_t count);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * create_nd_array_pool_t
+ */
+#define create_nd_array_pool_t(sizes, dims, elem_type, count) \
+	create_nd_array_pool((sizes), (dims), sizeof(elem_type), (count))
+
+
+/*
+ * try_acquire_nd_array_pool
+ * @param pool: pointer to the pool created by create_nd_array_pool
+ * @return: pointer to a multi-dimensional array, or NULL with errno set to EAGAIN if the pool is empty
+ * @note: This function never blocks.
+ */
+extern void* try_acquire_nd_array_pool (ndArrayPool* pool);
+
+
+/*
+ * acquire_nd_array_pool
+ * @param pool: pointer to the pool created by create_nd_array_pool
+ * @param timeout_ms: maximum time to wait in milliseconds (negative to wait indefinitely)
+ * @return: pointer to a multi-dimensional array, or NULL with errno set to ETIMEDOUT if none became available in time
+ */
+extern void* acquire_nd_array_pool (ndArrayPool* pool, long timeout_ms);
+
+
+/*
+ * release_nd_array_pool
+ * @param pool: pointer to the pool the array was acquired from
+ * @param array: pointer to the multi-dimensional array acquired from the pool
+ * @return: true if the array was returned to the pool, false if it does not belong to the pool or is not currently acquired (e.g., it was already released)
+ * @note: The array may be released from a different thread than the one that acquired it.
+ */
+extern bool release_nd_array_pool (ndArrayPool* pool, void* array);
+
+
+/*
+ * get_nd_array_pool_stats
+ * @param pool: pointer to the pool created by create_nd_array_pool
+ * @param result_stats: pointer to store the statistics
+ * @return: true if the statistics were stored, false if an error occurred
+ * @note: The counters are updated without locking, so a snapshot taken while other threads are active may be slightly inconsistent.
+ */
+extern bool get_nd_array_pool_stats (ndArrayPool* pool, ndArrayPoolStats* result_stats);
+
+
+/*
+ * destroy_nd_array_pool
+ * @param pool: pointer to the pool created by create_nd_array_pool (NULL is ignored)
+ * @note: This function releases the pool together with all of its arrays. No thread may be using or waiting on the pool.
+ */
+extern void destroy_nd_array_pool (ndArrayPool* pool);
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
@@ -0,0 +1,361 @@
+/*
+ * anda_pyramid.c -- implementation for multi-resolution pyramids of multi-dimensional
+ *                   arrays
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+
+
+#include "anda_pyramid.h"
+#include "anda_soa.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include "cver_compat.h"
+
+
+/* 最下層の次元の隣り合う2要素の和に使う SIMD 命令セット */
+#if defined (__SSE2__) && (defined (__x86_64__) || defined (_M_X64))
+	#include <emmintrin.h>
+	#define ANDA_PYRAMID_SSE2
+#elif defined (__aarch64__) && defined (__ARM_NEON)
+	#include <arm_neon.h>
+	#define ANDA_PYRAMID_NEON
+#endif
+
+
+size_t get_nd_array_pyramid_levels (const size_t sizes[], size_t dims) {
+	if (sizes == PTR_NULL || dims == 0) {
+		errno = EINVAL;
+		anda_errfunc = "get_nd_array_pyramid_levels";
+		return 0;
+	}
+
+	/* 最も大きい次元が1になるまでの段数 (floor(log2(n)) + 1) */
+	size_t levels = 1;
+	for (size_t d = 0; d < dims; d++) {
+		if (sizes[d] == 0) {
+			errno = EINVAL;
+			anda_errfunc = "get_nd_array_pyramid_levels";
+			return 0;
+		}
+
+		size_t count = 1;
+		for (size_t n = sizes[d]; n > 1; n >>= 1) count++;
+		if (count > levels) levels = count;
+	}
+	return levels;
+}
+
+
+static inline size_t half_size (size_t n) {
+	return (n > 1) ? n / 2 : 1;
+}
+
+
+bool get_nd_array_pyramid_sizes (const size_t sizes[], size_t dims, size_t level, size_t result_sizes[]) {
+	size_t full = get_nd_array_pyramid_levels(sizes, dims);
+	if (full == 0 || result_sizes == PTR_NULL || level >= full) {
+		errno = EINVAL;
+		anda_errfunc = "get_nd_array_pyramid_sizes";
+		return false;
+	}
+
+	for (size_t d = 0; d < dims; d++) {
+		size_t n = sizes[d];
+		for (size_t k = 0; k < level; k++) n = half_size(n);
+		result_sizes[d] = n;
+	}
+	return true;
+}
+
+
+/* 各段の形状を並べ、全ての段を1つのグループとして確保する */
+static void** alloc_pyramid_impl (const size_t sizes[], size_t dims, size_t levels, size_t elem_size, bool zero_fill) {
+	size_t full = get_nd_array_pyramid_levels(sizes, dims);
+	if (full == 0) return PTR_NULL;
+	if (levels == 0) levels = full;
+	if (levels > full || dims > SIZE_MAX / sizeof(size_t) / (full + 2)) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	/* [各段の形状 (levels * dims)][各段の次元数 (levels)][各段の要素サイズ (levels)] */
+	size_t* shapes = malloc((levels * dims + levels * 2) * sizeof(size_t));
+	const size_t** level_sizes = malloc(levels * sizeof(size_t*));
+	if (UNLIKELY(shapes == PTR_NULL || level_sizes == PTR_NULL)) {
+		free(shapes);
+		free(level_sizes);
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+
+	size_t* level_dims = shapes + levels * dims;
+	size_t* level_elem_sizes = level_dims + levels;
+	for (size_t k = 0; k < levels; k++) {
+		size_t* shape = shapes + k * dims;
+		for (size_t d = 0; d < dims; d++) {
+			shape[d] = (k == 0) ? sizes[d] : half_size(shapes[(k - 1) * dims + d]);
+		}
+		level_sizes[k] = shape;
+		level_dims[k] = dims;
+		level_elem_sizes[k] = elem_size;
+	}
+
+	void** pyramid = zero_fill ? calloc_nd_array_group(level_sizes, level_dims, level_elem_sizes, levels)
+	                           : alloc_nd_array_group(level_sizes, level_dims, level_elem_sizes, levels);
+	free(shapes);
+	free(level_sizes);
+	return pyramid;
+}
+
+
+void** alloc_nd_array_pyramid (const size_t sizes[], size_t dims, size_t levels, size_t elem_size) {
+	void** ptr = alloc_pyramid_impl(sizes, dims, levels, elem_size, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_nd_array_pyramid";
+	return ptr;
+}
+
+
+void** calloc_nd_array_pyramid (const size_t sizes[], size_t dims, size_t levels, size_t elem_size) {
+	void** ptr = alloc_pyramid_impl(sizes, dims, levels, elem_size, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_nd_array_pyramid";
+	return ptr;
+}
+
+
+/* 行 (最下層の次元) の隣り合う2要素の和を dst に書き込む (accumulate なら加算する) */
+static void pair_sum_float (float* dst, const float* src, size_t dst_count, size_t src_count, bool accumulate) {
+	if (src_count == 1) {  /* 長さ1の次元は同じ要素を2回使う */
+		dst[0] = accumulate ? dst[0] + (src[0] + src[0]) : src[0] + src[0];
+		return;
+	}
+
+	size_t j = 0;
+#if defined (ANDA_PYRAMID_SSE2)
+	for (; j + 4 <= dst_count; j += 4) {
+		__m128 a = _mm_loadu_ps(src + 2 * j);
+		__m128 b = _mm_loadu_ps(src + 2 * j + 4);
+		__m128 sum = _mm_add_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+		if (accumulate) sum = _mm_add_ps(sum, _mm_loadu_ps(dst + j));
+		_mm_storeu_ps(dst + j, sum);
+	}
+#elif defined (ANDA_PYRAMID_NEON)
+	for (; j + 4 <= dst_count; j += 4) {
+		float32x4x2_t pair = vld2q_f32(src + 2 * j);
+		float32x4_t sum = vaddq_f32(pair.val[0], pair.val[1]);
+		if (accumulate) sum = vaddq_f32(sum, vld1q_f32(dst + j));
+		vst1q_f32(dst + j, sum);
+	}
+#endif
+
+	for (; j < dst_count; j++) {
+		float sum = src[2 * j] + src[2 * j + 1];
+		dst[j] = accumulate ? dst[j] + sum : sum;
+	}
+}
+
+
+static void pair_sum_double (double* dst, const double* src, size_t dst_count, size_t src_count, bool accumulate) {
+	if (src_count == 1) {
+		dst[0] = accumulate ? dst[0] + (src[0] + src[0]) : src[0] + src[0];
+		return;
+	}
+
+	size_t j = 0;
+#if defined (ANDA_PYRAMID_SSE2)
+	for (; j + 2 <= dst_count; j += 2) {
+		__m128d a = _mm_loadu_pd(src + 2 * j);
+		__m128d b = _mm_loadu_pd(src + 2 * j + 2);
+		__m128d sum = _mm_add_pd(_mm_unpacklo_pd(a, b), _mm_unpackhi_pd(a, b));
+		if (accumulate) sum = _mm_add_pd(sum, _mm_loadu_pd(dst + j));
+		_mm_storeu_pd(dst + j, sum);
+	}
+#elif defined (ANDA_PYRAMID_NEON)
+	for (; j + 2 <= dst_count; j += 2) {
+		float64x2x2_t pair = vld2q_f64(src + 2 * j);
+		float64x2_t sum = vaddq_f64(pair.val[0], pair.val[1]);
+		if (accumulate) sum = vaddq_f64(sum, vld1q_f64(dst + j));
+		vst1q_f64(dst + j, sum);
+	}
+#endif
+
+	for (; j < dst_count; j++) {
+		double sum = src[2 * j] + src[2 * j + 1];
+		dst[j] = accumulate ? dst[j] + sum : sum;
+	}
+}
+
+
+/* ポインタテーブルをたどって行の先頭を求める (2次元以上) */
+static void* row_at (const void* array, const size_t index[], size_t dims) {
+	void* const* table = array;
+	for (size_t d = 0; d + 2 < dims; d++) {
+		table = table[index[d]];
+	}
+	return table[index[dims - 2]];
+}
+
+
+/*
+ * 縮小後の各行について、元の配列の 2^(dims-1) 本の行のそれぞれで隣り合う2要素の和を足し込み、
+ * 最後に 2^dims で割って平均にする
+ */
+static bool downsample_impl (void* dst, const void* src, const size_t src_sizes[], size_t dims, bool is_double) {
+	if (dst == PTR_NULL || src == PTR_NULL || src_sizes == PTR_NULL || dims == 0 ||
+		dims >= sizeof(size_t) * 8 || dims > SIZE_MAX / sizeof(size_t) / 3) {
+		errno = EINVAL;
+		return false;
+	}
+	for (size_t d = 0; d < dims; d++) {
+		if (src_sizes[d] == 0) {
+			errno = EINVAL;
+			return false;
+		}
+	}
+
+	/* [縮小後の形状][縮小後の添字][元の配列の添字] */
+	size_t* work = malloc(dims * 3 * sizeof(size_t));
+	if (UNLIKELY(work == PTR_NULL)) {
+		errno = ENOMEM;
+		return false;
+	}
+	size_t* dst_sizes = work;
+	size_t* dst_index = work + dims;
+	size_t* src_index = work + dims * 2;
+
+	size_t rows = 1;
+	for (size_t d = 0; d < dims; d++) {
+		dst_sizes[d] = half_size(src_sizes[d]);
+		dst_index[d] = 0;
+		if (d + 1 < dims) rows *= dst_sizes[d];
+	}
+
+	size_t dst_count = dst_sizes[dims - 1];
+	size_t src_count = src_sizes[dims - 1];
+	size_t combos = (size_t)1 << (dims - 1);
+	double scale = 1 / (double)(combos * 2);
+
+	for (size_t r = 0; r < rows; r++) {
+		void* dst_row = (dims == 1) ? dst : row_at(dst, dst_index, dims);
+
+		for (size_t c = 0; c < combos; c++) {
+			const void* src_row = src;
+			if (dims > 1) {
+				for (size_t d = 0; d + 1 < dims; d++) {
+					size_t index = dst_index[d] * 2 + ((c >> d) & 1u);
+					src_index[d] = (index < src_sizes[d]) ? index : src_sizes[d] - 1;
+				}
+				src_row = row_at(src, src_index, dims);
+			}
+
+			if (is_double)
+				pair_sum_double(dst_row, src_row, dst_count, src_count, c != 0);
+			else
+				pair_sum_float(dst_row, src_row, dst_count, src_count, c != 0);
+		}
+
+		if (is_double) {
+			double* row = dst_row;
+			for (size_t j = 0; j < dst_count; j++) row[j] *= scale;
+		} else {
+			float* row = dst_row;
+			float scale_float = (float)scale;  /* 2のべき乗の逆数なので float でも正確 */
+			for (size_t j = 0; j < dst_count; j++) row[j] *= scale_float;
+		}
+
+		/* 縮小後の添字を1行進める */
+		for (size_t d = dims - 1; d > 0; d--) {
+			if (++dst_index[d - 1] < dst_sizes[d - 1]) break;
+			dst_index[d - 1] = 0;
+		}
+	}
+
+	free(work);
+	return true;
+}
+
+
+bool downsample_nd_array_float (void* dst, const void* src, const size_t src_sizes[], size_t dims) {
+	bool result = downsample_impl(dst, src, src_sizes, dims, false);
+	if (!result) anda_errfunc = "downsample_nd_array_float";
+	return result;
+}
+
+
+bool downsample_nd_array_double (void* dst, const void* src, const size_t src_sizes[], size_t dims) {
+	bool result = downsample_impl(dst, src, src_sizes, dims, true);
+	if (!result) anda_errfunc = "downsample_nd_array_double";
+	return result;
+}
+
+
+/* 段 0 から順に、各段をすぐ上の段から縮小して埋める */
+static bool build_pyramid_impl (void** pyramid, const size_t sizes[], size_t dims, size_t levels, bool is_double) {
+	size_t full = get_nd_array_pyramid_levels(sizes, dims);
+	if (full == 0) return false;
+	if (levels == 0) levels = full;
+	if (pyramid == PTR_NULL || levels > full) {
+		errno = EINVAL;
+		return false;
+	}
+
+	size_t* level_sizes = malloc(dims * sizeof(size_t));
+	if (UNLIKELY(level_sizes == PTR_NULL)) {
+		errno = ENOMEM;
+		return false;
+	}
+
+	bool valid = true;
+	for (size_t d = 0; d < dims; d++) level_sizes[d] = sizes[d];
+	for (size_t k = 1; k < levels; k++) {
+		if (!downsample_impl(pyramid[k], pyramid[k - 1], level_sizes, dims, is_double)) {
+			valid = false;
+			break;
+		}
+		for (size_t d = 0; d < dims; d++) level_sizes[d] = half_size(level_sizes[d]);
+	}
+
+	free(level_sizes);
+	return valid;
+}
+
+
+bool build_nd_array_pyramid_float (void** pyramid, const size_t sizes[], size_t dims, size_t levels) {
+	bool result = build_pyramid_impl(pyramid, sizes, dims, levels, false);
+	if (!result) anda_errfunc = "build_nd_array_pyramid_float";
+	return result;
+}
+
+
+bool build_nd_array_pyramid_double (void** pyramid, const size_t sizes[], size_t dims, size_t levels) {
+	bool result = build_pyramid_impl(pyramid, sizes, dims, levels, true);
+	if (!result) anda_errfunc = "build_nd_array_pyramid_double";
+	return result;
+}
@@ -0,0 +1,186 @@
+/*
+ * anda_pyramid.h -- interface for multi-resolution pyramids of multi-dimensional
+ *                   arrays
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#pragma once
+
+#ifndef ANDA_PYRAMID_H
+#define ANDA_PYRAMID_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * A pyramid holds a multi-dimensional array (level 0) together with successively
+ * halved copies of it (mipmaps, multigrid levels), all in a single block. Each
+ * dimension of level k + 1 is half of that of level k, rounded down, but never less
+ * than 1. The block is a group (see anda_soa.h): it starts with the table of level
+ * pointers, every level is a standard multi-dimensional array whose data starts on an
+ * ANDA_GROUP_ALIGN boundary, and a single free() on the table releases everything.
+ *
+ * The downsample functions fill a level from the one above it by averaging each 2x2
+ * (2x2x2, ...) block of elements; along a dimension of odd size the last element is
+ * dropped, and along a dimension of size 1 it is reused.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+/*
+ * get_nd_array_pyramid_levels
+ * @param sizes: array containing sizes of level 0 for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions
+ * @return: number of levels of the full pyramid, down to a single element (0 on error, with errno set)
+ */
+extern size_t get_nd_array_pyramid_levels (const size_t sizes[], size_t dims);
+
+
+/*
+ * get_nd_array_pyramid_sizes
+ * @param sizes: array containing sizes of level 0 for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions
+ * @param level: level whose sizes are wanted (0 for the sizes themselves)
+ * @param result_sizes: array to store the sizes of the level (must have length equal to dims)
+ * @return: true if the sizes were stored, false if an error occurred (e.g., the level is beyond the full pyramid)
+ */
+extern bool get_nd_array_pyramid_sizes (const size_t sizes[], size_t dims, size_t level, size_t result_sizes[]);
+
+
+/*
+ * alloc_nd_array_pyramid
+ * @param sizes: array containing sizes of level 0 for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param levels: number of levels including level 0 (0 for the full pyramid, see get_nd_array_pyramid_levels)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the table of level arrays, or NULL on failure
+ * @note: Cast each entry of the returned table to the appropriate type (e.g., float** for a 2-D pyramid) to access that level. The allocated memory must be freed using free() on the returned table when no longer needed. The returned memory is uninitialized.
+ */
+extern void** alloc_nd_array_pyramid (const size_t sizes[], size_t dims, size_t levels, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_nd_array_pyramid_t
+ */
+#define alloc_nd_array_pyramid_t(sizes, dims, levels, elem_type) \
+	alloc_nd_array_pyramid((sizes), (dims), (levels), sizeof(elem_type))
+
+
+/*
+ * calloc_nd_array_pyramid
+ * @param sizes: array containing sizes of level 0 for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param levels: number of levels including level 0 (0 for the full pyramid, see get_nd_array_pyramid_levels)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the table of level arrays, or NULL on failure
+ * @note: Same as alloc_nd_array_pyramid, except that every level is set to zero.
+ */
+extern void** calloc_nd_array_pyramid (const size_t sizes[], size_t dims, size_t levels, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_nd_array_pyramid_t
+ */
+#define calloc_nd_array_pyramid_t(sizes, dims, levels, elem_type) \
+	calloc_nd_array_pyramid((sizes), (dims), (levels), sizeof(elem_type))
+
+
+/*
+ * downsample_nd_array_float
+ * @param dst: pointer to the multi-dimensional float array that receives the halved array (its sizes must be those of the next pyramid level)
+ * @param src: pointer to the multi-dimensional float array to halve
+ * @param src_sizes: array containing sizes of src for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions
+ * @return: true if dst was filled, false if an error occurred
+ * @note: dst and src may be any multi-dimensional arrays of the right shapes, not only levels of one pyramid. The pairs along the last dimension are summed with SSE2 or NEON when available.
+ */
+extern bool downsample_nd_array_float (void* dst, const void* src, const size_t src_sizes[], size_t dims);
+
+
+/*
+ * downsample_nd_array_double
+ * @param dst: pointer to the multi-dimensional double array that receives the halved array (its sizes must be those of the next pyramid level)
+ * @param src: pointer to the multi-dimensional double array to halve
+ * @param src_sizes: array containing sizes of src for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions
+ * @return: true if dst was filled, false if an error occurred
+ * @note: Same as downsample_nd_array_float, but for double elements.
+ */
+extern bool downsample_nd_array_double (void* dst, const void* src, const size_t src_sizes[], size_t dims);
+
+
+/*
+ * build_nd_array_pyramid_float
+ * @param pyramid: pointer to the table of levels allocated by alloc_nd_array_pyramid with sizeof(float), with level 0 already filled
+ * @param sizes: array containing sizes of level 0 for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions
+ * @param levels: the number of levels the pyramid was allocated with (0 for the full pyramid)
+ * @return: true if every level below 0 was filled, false if an error occurred
+ */
+extern bool build_nd_array_pyramid_float (void** pyramid, const size_t sizes[], size_t dims, size_t levels);
+
+
+/*
+ * build_nd_array_pyramid_double
+ * @param pyramid: pointer to the table of levels allocated by alloc_nd_array_pyramid with sizeof(double), with level 0 already filled
+ * @param sizes: array containing sizes of level 0 for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions
+ * @param levels: the number of levels the pyramid was allocated with (0 for the full pyramid)
+ * @return: true if every level below 0 was filled, false if an error occurred
+ */
+extern bool build_nd_array_pyramid_double (void** pyramid, const size_t sizes[], size_t dims, size_t levels);
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
@@ -0,0 +1,306 @@
+/*
+ * anda_ragged.c -- implementation of ragged multi-dimensional arrays whose rows have
+ *                  their own lengths
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+
+#include "anda_ragged.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+
+#if defined (__unix__) || defined (__APPLE__)
+	#include <pthread.h>
+	#include <unistd.h>
+	#define ANDA_RAGGED_THREADS
+#endif
+
+#include "cver_compat.h"
+
+
+#define RAGGED_MAX_THREADS 16  /* 累積和を分担するスレッド数の上限 */
+
+
+/* 1スレッドが担当する長さの配列の範囲 */
+typedef struct {
+	const size_t* lengths;
+	size_t first;
+	size_t last;
+	size_t sum;        /* 範囲内の長さの総和 */
+	bool overflow;     /* 総和が SIZE_MAX を超えた */
+	void** level;      /* 書き込むポインタの階層 */
+	char* target;      /* 指す先の領域 (次の階層またはデータ) の先頭 */
+	size_t unit;       /* 指す先の1要素のバイト数 */
+	size_t start;      /* 範囲の手前までの長さの総和 (排他的累積和) */
+} raggedTask;
+
+
+static void sum_range (raggedTask* task) {
+	size_t sum = 0;
+	task->overflow = false;
+	for (size_t e = task->first; e < task->last; e++) {
+		if (task->lengths[e] > SIZE_MAX - sum) {
+			task->overflow = true;
+			break;
+		}
+		sum += task->lengths[e];
+	}
+	task->sum = sum;
+}
+
+
+static void link_range (raggedTask* task) {
+	size_t offset = task->start;
+	for (size_t e = task->first; e < task->last; e++) {
+		task->level[e] = task->target + (offset * task->unit);
+		offset += task->lengths[e];
+	}
+	task->sum = offset - task->start;
+}
+
+
+#ifdef ANDA_RAGGED_THREADS
+static void* sum_task (void* arg) {
+	sum_range(arg);
+	return PTR_NULL;
+}
+
+
+static void* link_task (void* arg) {
+	link_range(arg);
+	return PTR_NULL;
+}
+#endif
+
+
+/* 要素数に応じてスレッド数を決め、範囲を等分する */
+static size_t split_range (raggedTask tasks[], const size_t lengths[], size_t count) {
+	size_t nthreads = 1;
+#ifdef ANDA_RAGGED_THREADS
+	if (count >= ANDA_RAGGED_PARALLEL_MIN) {
+		long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+		if (ncpu > 1) nthreads = (size_t)ncpu;
+		if (nthreads > RAGGED_MAX_THREADS) nthreads = RAGGED_MAX_THREADS;
+	}
+#endif
+
+	size_t chunk = count / nthreads;
+	for (size_t i = 0; i < nthreads; i++) {
+		tasks[i].lengths = lengths;
+		tasks[i].first = i * chunk;
+		tasks[i].last = (i == nthreads - 1) ? count : (i + 1) * chunk;
+	}
+	return nthreads;
+}
+
+
+/* 全ての範囲を処理する (スレッドを起動できなかった範囲は呼び出し元で処理する) */
+static void run_tasks (raggedTask tasks[], size_t nthreads, bool link) {
+#ifdef ANDA_RAGGED_THREADS
+	pthread_t threads[RAGGED_MAX_THREADS];
+	bool started[RAGGED_MAX_THREADS];
+	for (size_t i = 1; i < nthreads; i++) {
+		started[i] = (pthread_create(&threads[i], PTR_NULL, link ? link_task : sum_task, &tasks[i]) == 0);
+		if (!started[i]) {
+			if (link) link_range(&tasks[i]);
+			else sum_range(&tasks[i]);
+		}
+	}
+#endif
+
+	if (link) link_range(&tasks[0]);
+	else sum_range(&tasks[0]);
+
+#ifdef ANDA_RAGGED_THREADS
+	for (size_t i = 1; i < nthreads; i++) {
+		if (started[i]) pthread_join(threads[i], PTR_NULL);
+	}
+#else
+	(void)nthreads;
+#endif
+}
+
+
+/* 各範囲の総和を足し合わせる (溢れたら false) */
+static bool combine_sums (raggedTask tasks[], size_t nthreads, size_t* result) {
+	size_t total = 0;
+	for (size_t i = 0; i < nthreads; i++) {
+		if (tasks[i].overflow || tasks[i].sum > SIZE_MAX - total) return false;
+		tasks[i].start = total;
+		total += tasks[i].sum;
+	}
+	*result = total;
+	return true;
+}
+
+
+static bool sum_lengths (const size_t lengths[], size_t count, size_t* result) {
+	raggedTask tasks[RAGGED_MAX_THREADS];
+	size_t nthreads = split_range(tasks, lengths, count);
+	run_tasks(tasks, nthreads, false);
+	return combine_sums(tasks, nthreads, result);
+}
+
+
+/* level[e] に target から数えて lengths[0..e) の総和番目の位置を書き込み、長さの総和を返す */
+static size_t link_lengths (void** level, const size_t lengths[], size_t count, char* target, size_t unit) {
+	raggedTask tasks[RAGGED_MAX_THREADS];
+	size_t nthreads = split_range(tasks, lengths, count);
+
+	size_t total = 0;
+	if (nthreads > 1) {  /* 各範囲の総和を先に求め、その累積和を各範囲の開始位置にする */
+		run_tasks(tasks, nthreads, false);
+		combine_sums(tasks, nthreads, &total);  /* 溢れないことはサイズ計算で確認済み */
+	} else {
+		tasks[0].start = 0;
+	}
+
+	for (size_t i = 0; i < nthreads; i++) {
+		tasks[i].level = level;
+		tasks[i].target = target;
+		tasks[i].unit = unit;
+	}
+	run_tasks(tasks, nthreads, true);
+
+	return (nthreads > 1) ? total : tasks[0].sum;
+}
+
+
+bool calculate_ragged_nd_array_size (size_t outer, const size_t* const lengths[], size_t dims, size_t elem_size, size_t* result_ptrs_size, size_t* result_padding_size, size_t* result_total_elements) {
+	if (outer == 0 || lengths == PTR_NULL || dims < 2 || elem_size == 0 || result_ptrs_size == PTR_NULL ||
+		result_padding_size == PTR_NULL || result_total_elements == PTR_NULL) {
+		errno = EINVAL;
+		anda_errfunc = "calculate_ragged_nd_array_size";
+		return false;
+	}
+
+	/* 各階層のポインタ数は1つ上の階層の長さの総和になり、最後の総和が総要素数になる */
+	size_t count = outer;
+	size_t total_ptrs = 0;
+	for (size_t k = 0; k + 1 < dims; k++) {
+		if (lengths[k] == PTR_NULL || count > SIZE_MAX - total_ptrs) {
+			errno = EINVAL;
+			anda_errfunc = "calculate_ragged_nd_array_size";
+			return false;
+		}
+		total_ptrs += count;
+
+		if (!sum_lengths(lengths[k], count, &count)) {
+			errno = EINVAL;
+			anda_errfunc = "calculate_ragged_nd_array_size";
+			return false;
+		}
+	}
+
+	if (total_ptrs > (SIZE_MAX / sizeof(void*))) {
+		errno = EINVAL;
+		anda_errfunc = "calculate_ragged_nd_array_size";
+		return false;
+	}
+	size_t size_ptrs = total_ptrs * sizeof(void*);
+
+	/* アラインメント違反を防ぐため必要に応じて切り上げ */
+	size_t size_padding = 0;
+	if (elem_size > sizeof(void*)) {
+		size_t size_ptrs_max = anda_align_up(size_ptrs, elem_size);
+		if (size_ptrs_max == 0) {
+			errno = EINVAL;
+			anda_errfunc = "calculate_ragged_nd_array_size";
+			return false;
+		}
+		size_padding = size_ptrs_max - size_ptrs;
+	}
+
+	if ((count > (SIZE_MAX / elem_size)) ||
+	   ((count * elem_size) > (SIZE_MAX - size_ptrs - size_padding))) {
+		errno = EINVAL;
+		anda_errfunc = "calculate_ragged_nd_array_size";
+		return false;
+	}
+
+	*result_ptrs_size = size_ptrs;
+	*result_padding_size = size_padding;
+	*result_total_elements = count;
+	return true;
+}
+
+
+static void* alloc_ragged_impl (size_t outer, const size_t* const lengths[], size_t dims, size_t elem_size, bool zero_fill) {
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_ragged_nd_array_size(outer, lengths, dims, elem_size, &size_ptrs, &size_padding, &total_elements)) return PTR_NULL;
+
+	size_t size = size_ptrs + size_padding + (total_elements * elem_size);
+	char* block = zero_fill ? calloc(1, size) : malloc(size);
+	if (UNLIKELY(block == PTR_NULL)) {
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+
+	/* 階層ごとに累積和を取りながら、次の階層 (最下層ならデータ) を指すポインタを書き込む */
+	char* level = block;
+	size_t count = outer;
+	for (size_t k = 0; k + 1 < dims; k++) {
+		bool last = (k + 2 == dims);
+		char* target = last ? block + size_ptrs + size_padding : level + (count * sizeof(void*));
+		count = link_lengths((void**)(void*)level, lengths[k], count, target, last ? elem_size : sizeof(void*));
+		level = target;
+	}
+
+	return block;
+}
+
+
+void* alloc_ragged_nd_array (size_t outer, const size_t* const lengths[], size_t dims, size_t elem_size) {
+	void* ptr = alloc_ragged_impl(outer, lengths, dims, elem_size, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_ragged_nd_array";
+	return ptr;
+}
+
+
+void* calloc_ragged_nd_array (size_t outer, const size_t* const lengths[], size_t dims, size_t elem_size) {
+	void* ptr = alloc_ragged_impl(outer, lengths, dims, elem_size, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_ragged_nd_array";
+	return ptr;
+}
+
+
+void* alloc_ragged_array (const size_t row_lengths[], size_t nrows, size_t elem_size) {
+	const size_t* const lengths[1] = { row_lengths };
+	void* ptr = alloc_ragged_impl(nrows, lengths, 2, elem_size, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_ragged_array";
+	return ptr;
+}
+
+
+void* calloc_ragged_array (const size_t row_lengths[], size_t nrows, size_t elem_size) {
+	const size_t* const lengths[1] = { row_lengths };
+	void* ptr = alloc_ragged_impl(nrows, lengths, 2, elem_size, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_ragged_array";
+	return ptr;
+}
@@ -0,0 +1,181 @@
+/*
+ * anda_ragged.h -- interface for ragged multi-dimensional arrays whose rows have
+ *                  their own lengths
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#pragma once
+
+#ifndef ANDA_RAGGED_H
+#define ANDA_RAGGED_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * A ragged array has the same layout as an array of alloc_nd_array (pointer levels,
+ * padding, data, all in one block freed by a single free()), but every node has its
+ * own number of children. Its shape is described level by level:
+ *
+ *   outer      number of entries at the top level
+ *   lengths[0] number of children of each top-level entry (outer values)
+ *   lengths[k] number of children of each entry at level k, whose count is the sum of
+ *              lengths[k - 1]
+ *
+ * lengths[dims - 2] therefore holds the length of every innermost row. For a plain
+ * 2D ragged array (a[i][j] with j < row_lengths[i]), use alloc_ragged_array.
+ *
+ * Rows are laid out contiguously in order, so the data of a 2D ragged array is the
+ * values array of a CSR matrix, and the row pointers are its row offsets.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+/* Levels with at least this many entries are summed and linked by several threads */
+#ifndef ANDA_RAGGED_PARALLEL_MIN
+	#define ANDA_RAGGED_PARALLEL_MIN ((size_t)1 << 20)
+#endif
+
+
+/*
+ * alloc_ragged_array
+ * @param row_lengths: array containing the number of elements of each row (must have length equal to nrows; 0 is allowed)
+ * @param nrows: number of rows
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the ragged 2D array or NULL on failure
+ * @note: After calling, cast the returned pointer to the appropriate type (e.g., double**). The allocated memory must be freed using free() when no longer needed. The returned memory is uninitialized.
+ */
+extern void* alloc_ragged_array (const size_t row_lengths[], size_t nrows, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_ragged_array_t
+ */
+#define alloc_ragged_array_t(row_lengths, nrows, elem_type) \
+	alloc_ragged_array((row_lengths), (nrows), sizeof(elem_type))
+
+
+/*
+ * calloc_ragged_array
+ * @param row_lengths: array containing the number of elements of each row (must have length equal to nrows; 0 is allowed)
+ * @param nrows: number of rows
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the ragged 2D array or NULL on failure
+ * @note: Same as alloc_ragged_array, except that the elements are set to zero.
+ */
+extern void* calloc_ragged_array (const size_t row_lengths[], size_t nrows, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_ragged_array_t
+ */
+#define calloc_ragged_array_t(row_lengths, nrows, elem_type) \
+	calloc_ragged_array((row_lengths), (nrows), sizeof(elem_type))
+
+
+/*
+ * alloc_ragged_nd_array
+ * @param outer: number of entries at the top level
+ * @param lengths: array of dims - 1 arrays describing the number of children of every entry, level by level (see the top of this header)
+ * @param dims: number of array dimensions (must be 2 or more)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the ragged multi-dimensional array or NULL on failure
+ * @note: Each pointer level is built in a single pass of prefix sums; levels of at least ANDA_RAGGED_PARALLEL_MIN entries are split across threads. The allocated memory must be freed using free() when no longer needed. The returned memory is uninitialized.
+ */
+extern void* alloc_ragged_nd_array (size_t outer, const size_t* const lengths[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_ragged_nd_array_t
+ */
+#define alloc_ragged_nd_array_t(outer, lengths, dims, elem_type) \
+	alloc_ragged_nd_array((outer), (lengths), (dims), sizeof(elem_type))
+
+
+/*
+ * calloc_ragged_nd_array
+ * @param outer: number of entries at the top level
+ * @param lengths: array of dims - 1 arrays describing the number of children of every entry, level by level (see the top of this header)
+ * @param dims: number of array dimensions (must be 2 or more)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the ragged multi-dimensional array or NULL on failure
+ * @note: Same as alloc_ragged_nd_array, except that the elements are set to zero.
+ */
+extern void* calloc_ragged_nd_array (size_t outer, const size_t* const lengths[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_ragged_nd_array_t
+ */
+#define calloc_ragged_nd_array_t(outer, lengths, dims, elem_type) \
+	calloc_ragged_nd_array((outer), (lengths), (dims), sizeof(elem_type))
+
+
+/*
+ * calculate_ragged_nd_array_size
+ * @param outer: number of entries at the top level
+ * @param lengths: array of dims - 1 arrays describing the number of children of every entry, level by level (see the top of this header)
+ * @param dims: number of array dimensions (must be 2 or more)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param result_ptrs_size: pointer to store the total size of all pointer levels in bytes
+ * @param result_padding_size: pointer to store the padding inserted before the data for alignment
+ * @param result_total_elements: pointer to store the total number of elements
+ * @return: true if the sizes were calculated, false if an error occurred (e.g., overflow)
+ * @note: The block size is result_ptrs_size + result_padding_size + result_total_elements * elem_size. Levels of at least ANDA_RAGGED_PARALLEL_MIN entries are summed by several threads.
+ */
+extern bool calculate_ragged_nd_array_size (size_t outer, const size_t* const lengths[], size_t dims, size_t elem_size, size_t* result_ptrs_size, size_t* result_padding_size, size_t* result_total_elements);
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
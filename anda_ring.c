@@ -0,0 +1,171 @@
+/*
+ * anda_ring.c -- implementation of sliding windows over the outermost dimension of
+ *                multi-dimensional arrays
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+
+#include "anda_ring.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "cver_compat.h"
+
+
+struct ndArrayRing {
+	size_t count;        /* 最上位の次元の大きさ (ウィンドウの長さ) */
+	size_t start;        /* ウィンドウの先頭 (最も古い要素) の位置 */
+	size_t dims;
+	size_t slab_bytes;   /* 最上位の添字1つ分のデータのバイト数 */
+	void* table[];       /* 最上位のポインタを2周分並べたもの (table[start] から count 個がウィンドウ) */
+};
+
+
+static void reverse_pointers (void** table, size_t first, size_t last) {
+	while (first + 1 < last) {
+		void* tmp = table[first];
+		table[first] = table[last - 1];
+		table[last - 1] = tmp;
+		first++;
+		last--;
+	}
+}
+
+
+bool rotate_nd_array (void* array, const size_t sizes[], size_t dims, ptrdiff_t shift) {
+	if (array == PTR_NULL || sizes == PTR_NULL || dims < 2 || sizes[0] == 0) {
+		errno = EINVAL;
+		anda_errfunc = "rotate_nd_array";
+		return false;
+	}
+
+	/* 回転量を [0, n) に正規化する (負の値は PTRDIFF_MIN でも溢れないように絶対値を求める) */
+	size_t n = sizes[0];
+	size_t k;
+	if (shift >= 0) {
+		k = (size_t)shift % n;
+	} else {
+		size_t magnitude = (size_t)(-(shift + 1)) + 1;
+		k = (n - (magnitude % n)) % n;
+	}
+	if (k == 0) return true;
+
+	/* 3回の反転で左回転する (追加のメモリを使わない) */
+	void** table = array;
+	reverse_pointers(table, 0, k);
+	reverse_pointers(table, k, n);
+	reverse_pointers(table, 0, n);
+	return true;
+}
+
+
+ndArrayRing* create_nd_array_ring (void* array, const size_t sizes[], size_t dims, size_t elem_size) {
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_nd_array_size(sizes, dims, elem_size, &size_ptrs, &size_padding, &total_elements)) {
+		anda_errfunc = "create_nd_array_ring";
+		return PTR_NULL;
+	}
+
+	size_t count = sizes[0];
+	if (array == PTR_NULL || dims < 2 || count > (SIZE_MAX - sizeof(ndArrayRing)) / (2 * sizeof(void*))) {
+		errno = EINVAL;
+		anda_errfunc = "create_nd_array_ring";
+		return PTR_NULL;
+	}
+
+	ndArrayRing* ring = malloc(sizeof(ndArrayRing) + (2 * count * sizeof(void*)));
+	if (UNLIKELY(ring == PTR_NULL)) {
+		errno = ENOMEM;
+		anda_errfunc = "create_nd_array_ring";
+		return PTR_NULL;
+	}
+
+	ring->count = count;
+	ring->start = 0;
+	ring->dims = dims;
+	ring->slab_bytes = (total_elements / count) * elem_size;
+
+	/* 2周分並べておけば、どの位置から count 個取り出しても連続した表になる */
+	void** top = array;
+	memcpy(ring->table, top, count * sizeof(void*));
+	memcpy(ring->table + count, top, count * sizeof(void*));
+
+	return ring;
+}
+
+
+void* get_nd_array_ring_window (ndArrayRing* ring) {
+	if (UNLIKELY(ring == PTR_NULL)) {
+		errno = EINVAL;
+		anda_errfunc = "get_nd_array_ring_window";
+		return PTR_NULL;
+	}
+
+	return ring->table + ring->start;
+}
+
+
+void* advance_nd_array_ring (ndArrayRing* ring) {
+	if (UNLIKELY(ring == PTR_NULL)) {
+		errno = EINVAL;
+		anda_errfunc = "advance_nd_array_ring";
+		return PTR_NULL;
+	}
+
+	/* 最も古い要素がそのまま最も新しい要素になる */
+	void* newest = ring->table[ring->start];
+	if (++ring->start == ring->count) ring->start = 0;
+	return newest;
+}
+
+
+void* push_nd_array_ring (ndArrayRing* ring, const void* src) {
+	if (UNLIKELY(ring == PTR_NULL || src == PTR_NULL)) {
+		errno = EINVAL;
+		anda_errfunc = "push_nd_array_ring";
+		return PTR_NULL;
+	}
+
+	void* newest = advance_nd_array_ring(ring);
+
+	/* 最下層の手前まで先頭のポインタをたどり、この添字のデータの先頭を求める (データは連続している) */
+	void* data = newest;
+	for (size_t k = 2; k < ring->dims; k++) {
+		data = *(void**)data;
+	}
+	memcpy(data, src, ring->slab_bytes);
+
+	return newest;
+}
+
+
+void destroy_nd_array_ring (ndArrayRing* ring) {
+	free(ring);
+}
@@ -0,0 +1,150 @@
+/*
+ * anda_ring.h -- interface for sliding windows over the outermost dimension of
+ *                multi-dimensional arrays
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#pragma once
+
+#ifndef ANDA_RING_H
+#define ANDA_RING_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * Every outermost index of an array allocated by alloc_nd_array is reached through
+ * the top-level pointer table. A sliding window over the outermost dimension can
+ * therefore be moved by reordering those pointers instead of moving the data: the
+ * oldest sub-array is reused as the newest one.
+ *
+ * rotate_nd_array reorders the top-level pointers of the array itself in O(N).
+ * A ring (ndArrayRing) keeps a separate top-level table of twice the length, so its
+ * window moves by one step in O(1) and the array itself is never modified.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+typedef struct ndArrayRing ndArrayRing;
+
+
+/*
+ * rotate_nd_array
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array or calloc_nd_array (2 or more dimensions)
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (must be 2 or more)
+ * @param shift: number of positions to rotate by; index i afterwards refers to what index (i + shift) mod sizes[0] referred to before (negative values rotate the other way)
+ * @return: true if the array was rotated, false if an error occurred
+ * @note: Only the sizes[0] top-level pointers are reordered; no element is moved. After a rotation that is not a multiple of sizes[0], the outermost order no longer matches the order in memory, so the array must not be passed to functions that rely on the layout (realloc_nd_array, relayout_nd_array and the like) until it is rotated back. Whole-block copies such as clone_nd_array are unaffected.
+ */
+extern bool rotate_nd_array (void* array, const size_t sizes[], size_t dims, ptrdiff_t shift);
+
+
+/*
+ * create_nd_array_ring
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array or calloc_nd_array (2 or more dimensions)
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (must be 2 or more)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the ring or NULL on failure
+ * @note: The ring does not take ownership of the array, which must outlive the ring and is freed separately. The ring must be released with destroy_nd_array_ring. A ring is not thread-safe.
+ */
+extern ndArrayRing* create_nd_array_ring (void* array, const size_t sizes[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * create_nd_array_ring_t
+ */
+#define create_nd_array_ring_t(array, sizes, dims, elem_type) \
+	create_nd_array_ring((array), (sizes), (dims), sizeof(elem_type))
+
+
+/*
+ * get_nd_array_ring_window
+ * @param ring: pointer to the ring created by create_nd_array_ring
+ * @return: pointer usable in place of the array (e.g., as double***), in which index 0 is the oldest sub-array and index sizes[0] - 1 the newest
+ * @note: The returned pointer changes every time the window moves, so fetch it again after advance_nd_array_ring or push_nd_array_ring.
+ */
+extern void* get_nd_array_ring_window (ndArrayRing* ring);
+
+
+/*
+ * advance_nd_array_ring
+ * @param ring: pointer to the ring created by create_nd_array_ring
+ * @return: pointer to the sub-array that has just become the newest (it still holds the contents of the oldest one, ready to be overwritten), or NULL on failure
+ * @note: This function moves the window by one step in constant time, without touching the array.
+ */
+extern void* advance_nd_array_ring (ndArrayRing* ring);
+
+
+/*
+ * push_nd_array_ring
+ * @param ring: pointer to the ring created by create_nd_array_ring
+ * @param src: elements of the incoming sub-array, stored contiguously in row-major order (sizes[1] * ... * sizes[dims - 1] elements)
+ * @return: pointer to the sub-array that has just become the newest, or NULL on failure
+ * @note: Same as advance_nd_array_ring followed by copying src into the data of the newest sub-array.
+ */
+extern void* push_nd_array_ring (ndArrayRing* ring, const void* src);
+
+
+/*
+ * destroy_nd_array_ring
+ * @param ring: pointer to the ring created by create_nd_array_ring (NULL is ignored)
+ * @note: The array the ring was created over is not freed.
+ */
+extern void destroy_nd_array_ring (ndArrayRing* ring);
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
@@ -0,0 +1,260 @@
+/*
+ * anda_slab.c -- implementation of a slab allocator that packs many small
+ *                multi-dimensional arrays of one fixed shape into shared pages
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+#include "anda_slab.h"
+#include "anda_llapi.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+
+#include "cver_compat.h"
+
+
+#if !defined (__STDC_VERSION__) || (__STDC_VERSION__ < 201112L) || defined (__STDC_NO_ATOMICS__)
+	#error "anda_slab.c requires C11 atomics."
+#endif
+
+
+#if !defined (__unix__) && !defined (__APPLE__)
+	#error "anda_slab.c requires a POSIX environment (mmap)."
+#endif
+
+
+#if !defined (MAP_ANONYMOUS) && defined (MAP_ANON)
+	#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#ifndef MAP_NORESERVE
+	#define MAP_NORESERVE 0
+#endif
+
+
+#define SLAB_PAGE_SIZE ((size_t)2 << 20)       /* 2 MB (x86-64 / AArch64 のヒュージページ) */
+#define SLAB_MIN_ALIGN (2 * sizeof(void*))     /* malloc と同じ最低保証アラインメント */
+#define SLAB_INDEX_MASK ((uint64_t)0xFFFFFFFF)
+
+
+struct ndArraySlab {
+	char* region;                   /* 2 MB 境界に揃えたスロット領域の先頭 */
+	size_t region_size;
+	size_t slot_size;
+	size_t max_arrays;
+	uintptr_t* template_ptrs;       /* スロット先頭からのオフセットで表したポインタテーブルの雛形 */
+	size_t template_count;
+	_Atomic uint64_t free_head;     /* 上位32ビット: ABA 対策のタグ、下位32ビット: スロット番号 + 1 (0 は空) */
+	_Atomic size_t fresh;           /* まだ一度も使われていないスロットの先頭番号 */
+};
+
+
+/* 2 MB 境界に揃った領域を予約する (物理メモリは初回アクセス時に割り当てられる) */
+static char* reserve_region (size_t size) {
+	size_t reserve = size + SLAB_PAGE_SIZE;
+	void* raw = mmap(PTR_NULL, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (raw == MAP_FAILED) return PTR_NULL;
+
+	/* 先頭と末尾の余りを切り落として 2 MB 境界に揃える */
+	uintptr_t addr = (uintptr_t)raw;
+	uintptr_t aligned = (addr + (SLAB_PAGE_SIZE - 1)) & ~(uintptr_t)(SLAB_PAGE_SIZE - 1);
+	size_t head = (size_t)(aligned - addr);
+	size_t tail = reserve - head - size;
+
+	char* region = (char*)raw + head;
+	if (head != 0) munmap(raw, head);
+	if (tail != 0) munmap(region + size, tail);
+
+#ifdef MADV_HUGEPAGE
+	madvise(region, size, MADV_HUGEPAGE);  /* 失敗しても通常ページで動作するので無視する */
+#endif
+
+	return region;
+}
+
+
+static inline _Atomic uint64_t* slot_link (char* slot) {
+	return (_Atomic uint64_t*)(void*)slot;  /* 空きスロットの先頭8バイトを次のスロット番号の格納に使う */
+}
+
+
+ndArraySlab* create_nd_array_slab (const size_t sizes[], size_t dims, size_t elem_size, size_t max_arrays) {
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_nd_array_size(sizes, dims, elem_size, &size_ptrs, &size_padding, &total_elements)) {
+		anda_errfunc = "create_nd_array_slab";
+		return PTR_NULL;
+	}
+
+	if (max_arrays == 0 || max_arrays >= SLAB_INDEX_MASK) {
+		errno = EINVAL;
+		anda_errfunc = "create_nd_array_slab";
+		return PTR_NULL;
+	}
+
+	/* 要素サイズが2のべき乗ならスロット境界もそれに揃える (データ部分のアラインメントを保つため) */
+	size_t slot_align = SLAB_MIN_ALIGN;
+	if (elem_size > slot_align && elem_size <= 4096 && (elem_size & (elem_size - 1)) == 0)
+		slot_align = elem_size;
+
+	size_t block_size = size_ptrs + size_padding + (total_elements * elem_size);
+	if (block_size < sizeof(uint64_t)) block_size = sizeof(uint64_t);
+
+	size_t slot_size = anda_align_up(block_size, slot_align);
+	if (slot_size == 0 || max_arrays > (SIZE_MAX - SLAB_PAGE_SIZE) / slot_size) {
+		errno = EINVAL;
+		anda_errfunc = "create_nd_array_slab";
+		return PTR_NULL;
+	}
+	size_t region_size = anda_align_up(max_arrays * slot_size, SLAB_PAGE_SIZE);
+	if (region_size == 0 || region_size > SIZE_MAX - SLAB_PAGE_SIZE) {
+		errno = EINVAL;
+		anda_errfunc = "create_nd_array_slab";
+		return PTR_NULL;
+	}
+
+	ndArraySlab* slab = malloc(sizeof(ndArraySlab));
+	if (UNLIKELY(slab == PTR_NULL)) {
+		errno = ENOMEM;
+		anda_errfunc = "create_nd_array_slab";
+		return PTR_NULL;
+	}
+
+	slab->template_count = size_ptrs / sizeof(void*);
+	slab->template_ptrs = PTR_NULL;
+	if (slab->template_count != 0) {
+		slab->template_ptrs = malloc(slab->template_count * sizeof(uintptr_t));
+		if (UNLIKELY(slab->template_ptrs == PTR_NULL)) {
+			free(slab);
+			errno = ENOMEM;
+			anda_errfunc = "create_nd_array_slab";
+			return PTR_NULL;
+		}
+	}
+
+	slab->region = reserve_region(region_size);
+	if (UNLIKELY(slab->region == PTR_NULL)) {
+		free(slab->template_ptrs);
+		free(slab);
+		errno = ENOMEM;
+		anda_errfunc = "create_nd_array_slab";
+		return PTR_NULL;
+	}
+
+	/* 先頭スロットに実際にポインタテーブルを組み立て、その相対位置を雛形として保存する */
+	if (slab->template_count != 0) {
+		void** table = initialize_nd_array(slab->region, sizes, dims, elem_size, size_ptrs, size_padding, total_elements);
+		for (size_t i = 0; i < slab->template_count; i++) {
+			slab->template_ptrs[i] = (uintptr_t)table[i] - (uintptr_t)slab->region;
+		}
+	}
+
+	slab->region_size = region_size;
+	slab->slot_size = slot_size;
+	slab->max_arrays = max_arrays;
+	atomic_init(&slab->free_head, 0);
+	atomic_init(&slab->fresh, 0);
+
+	return slab;
+}
+
+
+void* alloc_nd_array_slab (ndArraySlab* slab) {
+	if (UNLIKELY(slab == PTR_NULL)) {
+		errno = EINVAL;
+		anda_errfunc = "alloc_nd_array_slab";
+		return PTR_NULL;
+	}
+
+	/* 空きリストから取り出す (Treiber stack) */
+	uint64_t head = atomic_load_explicit(&slab->free_head, memory_order_acquire);
+	while ((head & SLAB_INDEX_MASK) != 0) {
+		char* slot = slab->region + (((size_t)(head & SLAB_INDEX_MASK) - 1) * slab->slot_size);
+		uint64_t next = atomic_load_explicit(slot_link(slot), memory_order_relaxed);
+		uint64_t new_head = (((head >> 32) + 1) << 32) | (next & SLAB_INDEX_MASK);
+
+		if (atomic_compare_exchange_weak_explicit(&slab->free_head, &head, new_head, memory_order_acquire, memory_order_acquire)) {
+			/* 空きリストのリンクで上書きされた先頭のポインタだけを戻す (雛形からの再配置) */
+			if (slab->template_count != 0) {
+				void** table = (void**)(void*)slot;
+				table[0] = slot + slab->template_ptrs[0];
+			}
+			return slot;
+		}
+	}
+
+	/* 空きがなければ未使用スロットを切り出す */
+	size_t index = atomic_load_explicit(&slab->fresh, memory_order_relaxed);
+	do {
+		if (UNLIKELY(index >= slab->max_arrays)) {
+			errno = ENOMEM;
+			anda_errfunc = "alloc_nd_array_slab";
+			return PTR_NULL;
+		}
+	} while (!atomic_compare_exchange_weak_explicit(&slab->fresh, &index, index + 1, memory_order_relaxed, memory_order_relaxed));
+
+	/* 初回利用のスロットは雛形に基底アドレスを足すだけでポインタテーブルが完成する */
+	char* slot = slab->region + (index * slab->slot_size);
+	void** table = (void**)(void*)slot;
+	for (size_t i = 0; i < slab->template_count; i++) {
+		table[i] = slot + slab->template_ptrs[i];
+	}
+	return slot;
+}
+
+
+void free_nd_array_slab (ndArraySlab* slab, void* array) {
+	if (array == PTR_NULL) return;
+
+	char* slot = array;
+	if (UNLIKELY(slab == PTR_NULL || slot < slab->region || slot >= slab->region + (slab->max_arrays * slab->slot_size) ||
+		((size_t)(slot - slab->region) % slab->slot_size) != 0)) {
+		errno = EINVAL;
+		anda_errfunc = "free_nd_array_slab";
+		return;
+	}
+
+	uint64_t node = (uint64_t)((size_t)(slot - slab->region) / slab->slot_size) + 1;
+
+	/* 空きリストへ戻す (Treiber stack) */
+	uint64_t head = atomic_load_explicit(&slab->free_head, memory_order_relaxed);
+	uint64_t new_head;
+	do {
+		atomic_store_explicit(slot_link(slot), head & SLAB_INDEX_MASK, memory_order_relaxed);
+		new_head = (((head >> 32) + 1) << 32) | node;
+	} while (!atomic_compare_exchange_weak_explicit(&slab->free_head, &head, new_head, memory_order_release, memory_order_relaxed));
+}
+
+
+void destroy_nd_array_slab (ndArraySlab* slab) {
+	if (slab == PTR_NULL) return;
+
+	munmap(slab->region, slab->region_size);
+	free(slab->template_ptrs);
+	free(slab);
+}
@@ -0,0 +1,128 @@
+/*
+ * anda_slab.h -- interface of a slab allocator that packs many small multi-dimensional
+ *                arrays of one fixed shape into shared pages
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+#pragma once
+
+#ifndef ANDA_SLAB_H
+#define ANDA_SLAB_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * A slab serves multi-dimensional arrays of a single (shape, elem_size) pair.
+ *
+ * Each array occupies a fixed-size slot carved out of a contiguous region backed by
+ * 2 MB (transparent huge) pages. The pointer table of a slot is built from a template
+ * when the slot is first used and survives later reuse, so allocating and freeing are
+ * a single lock-free operation on a free list.
+ *
+ * Arrays obtained from a slab must be returned with free_nd_array_slab, never with
+ * free() or free_nd_array. All functions except create and destroy are thread-safe.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+typedef struct ndArraySlab ndArraySlab;
+
+
+/*
+ * create_nd_array_slab
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @param max_arrays: maximum number of arrays that can be live at the same time
+ * @return: pointer to the slab or NULL on failure
+ * @note: Only address space for max_arrays slots is reserved here; physical memory is committed as slots are first used. The slab must be released with destroy_nd_array_slab.
+ */
+extern ndArraySlab* create_nd_array_slab (const size_t sizes[], size_t dims, size_t elem_size, size_t max_arrays);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * create_nd_array_slab_t
+ */
+#define create_nd_array_slab_t(sizes, dims, elem_type, max_arrays) \
+	create_nd_array_slab((sizes), (dims), sizeof(elem_type), (max_arrays))
+
+
+/*
+ * alloc_nd_array_slab
+ * @param slab: pointer to the slab created by create_nd_array_slab
+ * @return: pointer to the multi-dimensional array or NULL on failure (errno is set to ENOMEM when max_arrays arrays are live)
+ * @note: After calling, cast the returned pointer to the appropriate type (e.g., int***, double**, etc.) to access it as the multi-dimensional array. The returned memory is uninitialized.
+ */
+extern void* alloc_nd_array_slab (ndArraySlab* slab);
+
+
+/*
+ * free_nd_array_slab
+ * @param slab: pointer to the slab the array was allocated from
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_slab (NULL is ignored)
+ * @note: The pointer table of the array must not have been modified by the caller.
+ */
+extern void free_nd_array_slab (ndArraySlab* slab, void* array);
+
+
+/*
+ * destroy_nd_array_slab
+ * @param slab: pointer to the slab created by create_nd_array_slab (NULL is ignored)
+ * @note: This function releases the slab together with every array allocated from it.
+ */
+extern void destroy_nd_array_slab (ndArraySlab* slab);
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * anda_soa.c -- implementation for groups of multi-dimensional arrays sharing one
+ *               block, such as struct-of-arrays fields
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+
+
+#include "anda_soa.h"
+#include "anda_llapi.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include "cver_compat.h"
+
+
+/* 形状1つ分のポインタテーブルのサイズ (ANDA_GROUP_ALIGN の倍数に切り上げたものも) と総要素数を計算する */
+static bool shape_size (const size_t sizes[], size_t dims, size_t* size_ptrs, size_t* aligned_ptrs, size_t* total_elements) {
+	size_t size_padding;  /* データ部分の位置は独自に決めるので使わない */
+	if (!calculate_nd_array_size(sizes, dims, 1, size_ptrs, &size_padding, total_elements)) return false;
+
+	if (*size_ptrs > SIZE_MAX - (ANDA_GROUP_ALIGN - 1)) {
+		errno = EINVAL;
+		return false;
+	}
+	*aligned_ptrs = anda_align_up(*size_ptrs, ANDA_GROUP_ALIGN);
+	return true;
+}
+
+
+/* メンバー1つ分のデータ部分のサイズを ANDA_GROUP_ALIGN の倍数に切り上げて計算する */
+static bool data_size (size_t total_elements, size_t elem_size, size_t* aligned_data) {
+	if (elem_size == 0 || total_elements > (SIZE_MAX / elem_size) || (total_elements * elem_size) > SIZE_MAX - (ANDA_GROUP_ALIGN - 1)) {
+		errno = EINVAL;
+		return false;
+	}
+	*aligned_data = anda_align_up(total_elements * elem_size, ANDA_GROUP_ALIGN);
+	return true;
+}
+
+
+/*
+ * 各メンバーのポインタテーブルとデータをそれぞれ ANDA_GROUP_ALIGN の倍数の位置に置く
+ * sizes が NULL の場合は全メンバーが shared_sizes の形状を持つ (ポインタテーブルの計算は1回だけ行う)
+ */
+static void** alloc_group_impl (const size_t* const sizes[], const size_t dims[], const size_t shared_sizes[], size_t shared_dims, const size_t elem_sizes[], size_t count, bool zero_fill) {
+	if (((sizes == PTR_NULL) ? (shared_sizes == PTR_NULL) : (dims == PTR_NULL)) ||
+		elem_sizes == PTR_NULL || count == 0 || count > (SIZE_MAX / sizeof(void*))) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	/* 先頭のメンバーテーブルの後ろに、malloc の返すアラインメントの不足分を含めて各メンバーを並べる */
+	size_t size_table = count * sizeof(void*);
+	size_t total_size = size_table + (ANDA_GROUP_ALIGN - 1);
+
+	size_t shared_ptrs = 0, shared_aligned = 0, shared_total = 0;
+	if (sizes == PTR_NULL) {
+		if (!shape_size(shared_sizes, shared_dims, &shared_ptrs, &shared_aligned, &shared_total)) return PTR_NULL;
+		if (shared_aligned > (SIZE_MAX - total_size) / count) {
+			errno = EINVAL;
+			return PTR_NULL;
+		}
+		total_size += shared_aligned * count;
+	}
+
+	for (size_t k = 0; k < count; k++) {
+		size_t size_ptrs, aligned_ptrs = 0, total_elements = shared_total, aligned_data;
+		if (sizes != PTR_NULL && !shape_size(sizes[k], dims[k], &size_ptrs, &aligned_ptrs, &total_elements)) return PTR_NULL;
+		if (!data_size(total_elements, elem_sizes[k], &aligned_data)) return PTR_NULL;
+
+		if (aligned_ptrs > SIZE_MAX - aligned_data || (aligned_ptrs + aligned_data) > SIZE_MAX - total_size) {
+			errno = EINVAL;
+			return PTR_NULL;
+		}
+		total_size += aligned_ptrs + aligned_data;
+	}
+
+	void** table = zero_fill ? calloc(1, total_size) : malloc(total_size);
+	if (UNLIKELY(table == PTR_NULL)) {
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+
+	uintptr_t cursor = ((uintptr_t)table + size_table + (ANDA_GROUP_ALIGN - 1)) & ~(uintptr_t)(ANDA_GROUP_ALIGN - 1);
+	for (size_t k = 0; k < count; k++) {
+		const size_t* member_sizes = shared_sizes;
+		size_t member_dims = shared_dims;
+		size_t size_ptrs = shared_ptrs, aligned_ptrs = shared_aligned, total_elements = shared_total;
+		if (sizes != PTR_NULL) {
+			member_sizes = sizes[k];
+			member_dims = dims[k];
+			shape_size(member_sizes, member_dims, &size_ptrs, &aligned_ptrs, &total_elements);  /* 上で検証済み */
+		}
+		size_t aligned_data = anda_align_up(total_elements * elem_sizes[k], ANDA_GROUP_ALIGN);  /* 上で検証済み */
+
+		table[k] = initialize_nd_array((void*)cursor, member_sizes, member_dims, elem_sizes[k], size_ptrs, aligned_ptrs - size_ptrs, total_elements);
+		cursor += aligned_ptrs + aligned_data;
+	}
+
+	return table;
+}
+
+
+void** alloc_nd_array_group (const size_t* const sizes[], const size_t dims[], const size_t elem_sizes[], size_t count) {
+	void** ptr = alloc_group_impl(sizes, dims, PTR_NULL, 0, elem_sizes, count, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_nd_array_group";
+	return ptr;
+}
+
+
+void** calloc_nd_array_group (const size_t* const sizes[], const size_t dims[], const size_t elem_sizes[], size_t count) {
+	void** ptr = alloc_group_impl(sizes, dims, PTR_NULL, 0, elem_sizes, count, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_nd_array_group";
+	return ptr;
+}
+
+
+/* 全フィールドが同じ形状を持つグループとして確保する */
+static void** alloc_soa_impl (const size_t sizes[], size_t dims, const size_t field_sizes[], size_t nfields, bool zero_fill) {
+	return alloc_group_impl(PTR_NULL, PTR_NULL, sizes, dims, field_sizes, nfields, zero_fill);
+}
+
+
+void** alloc_nd_array_soa (const size_t sizes[], size_t dims, const size_t field_sizes[], size_t nfields) {
+	void** ptr = alloc_soa_impl(sizes, dims, field_sizes, nfields, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_nd_array_soa";
+	return ptr;
+}
+
+
+void** calloc_nd_array_soa (const size_t sizes[], size_t dims, const size_t field_sizes[], size_t nfields) {
+	void** ptr = alloc_soa_impl(sizes, dims, field_sizes, nfields, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_nd_array_soa";
+	return ptr;
+}
@@ -0,0 +1,135 @@
+/*
+ * anda_soa.h -- interface for groups of multi-dimensional arrays sharing one block,
+ *               such as struct-of-arrays fields
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#pragma once
+
+#ifndef ANDA_SOA_H
+#define ANDA_SOA_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * A group is a set of multi-dimensional arrays allocated in a single block. The block
+ * starts with a table holding one pointer per member, so the value returned here is
+ * both that table and the pointer to pass to free(). Each member is a standard
+ * multi-dimensional array with its own pointer tables, and the data of every member
+ * starts on an ANDA_GROUP_ALIGN boundary.
+ *
+ * The struct-of-arrays functions build a group whose members all have the same shape,
+ * one per field of an element type. A kernel that touches only some fields then
+ * streams only their data, and each field can be vectorized on its own. The members
+ * must not be passed to free(), realloc_nd_array or other functions that take
+ * ownership of a block; free the whole group instead.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+/* Alignment in bytes of the data region of every member (one cache line, enough for any SIMD load) */
+#define ANDA_GROUP_ALIGN 64
+
+
+/*
+ * alloc_nd_array_group
+ * @param sizes: array of count pointers, each to the sizes of one member (with length equal to the corresponding entry of dims)
+ * @param dims: array containing the number of dimensions of each member (must have length equal to count)
+ * @param elem_sizes: array containing the element size of each member in bytes (must have length equal to count)
+ * @param count: number of members
+ * @return: pointer to the table of count member arrays, or NULL on failure
+ * @note: Cast each entry of the returned table to the appropriate type (e.g., int***, double**, etc.) to access that member. The allocated memory must be freed using free() on the returned table when no longer needed. The returned memory is uninitialized.
+ */
+extern void** alloc_nd_array_group (const size_t* const sizes[], const size_t dims[], const size_t elem_sizes[], size_t count);
+
+
+/*
+ * calloc_nd_array_group
+ * @param sizes: array of count pointers, each to the sizes of one member (with length equal to the corresponding entry of dims)
+ * @param dims: array containing the number of dimensions of each member (must have length equal to count)
+ * @param elem_sizes: array containing the element size of each member in bytes (must have length equal to count)
+ * @param count: number of members
+ * @return: pointer to the table of count member arrays, or NULL on failure
+ * @note: Same as alloc_nd_array_group, except that the elements of every member are set to zero.
+ */
+extern void** calloc_nd_array_group (const size_t* const sizes[], const size_t dims[], const size_t elem_sizes[], size_t count);
+
+
+/*
+ * alloc_nd_array_soa
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param field_sizes: array containing the size of each field in bytes (must have length equal to nfields)
+ * @param nfields: number of fields
+ * @return: pointer to the table of nfields field arrays, or NULL on failure
+ * @note: For an element type such as struct { float x, y, z; int id; }, pass field_sizes = { sizeof(float), sizeof(float), sizeof(float), sizeof(int) } and access field k of element (i, j) as ((float**)soa[k])[i][j]. The allocated memory must be freed using free() on the returned table when no longer needed. The returned memory is uninitialized.
+ */
+extern void** alloc_nd_array_soa (const size_t sizes[], size_t dims, const size_t field_sizes[], size_t nfields);
+
+
+/*
+ * calloc_nd_array_soa
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (designed for 2+ dimensions but supports 1D arrays)
+ * @param field_sizes: array containing the size of each field in bytes (must have length equal to nfields)
+ * @param nfields: number of fields
+ * @return: pointer to the table of nfields field arrays, or NULL on failure
+ * @note: Same as alloc_nd_array_soa, except that every field is set to zero.
+ */
+extern void** calloc_nd_array_soa (const size_t sizes[], size_t dims, const size_t field_sizes[], size_t nfields);
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
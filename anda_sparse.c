@@ -0,0 +1,270 @@
+/*
+ * anda_sparse.c -- implementation for multi-dimensional arrays whose rows are
+ *                  allocated on first write
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+
+
+#include "anda_sparse.h"
+#include "anda_llapi.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#if defined (__unix__) || defined (__APPLE__)
+	#define ANDA_SPARSE_MMAP
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#if !defined (MAP_ANONYMOUS) && defined (MAP_ANON)
+		#define MAP_ANONYMOUS MAP_ANON
+	#endif
+#endif
+
+#include "cver_compat.h"
+
+
+#define SPARSE_HEADER_SIZE 128  /* 配列の直前に置く隠しヘッダの領域 */
+#define SPARSE_ROW_ALIGN 16     /* スラブ内の最初の行とブロック内のゼロ行を揃える境界 */
+#define SPARSE_MAGIC ((uint32_t)0x414E4453)  /* "ANDS" */
+
+
+/* 実体化した行を切り出すスラブ (連結リストで保持し、解放時にまとめて返す) */
+typedef struct sparseSlab {
+	struct sparseSlab* next;
+} sparseSlab;
+
+_Static_assert(sizeof(sparseSlab) <= SPARSE_ROW_ALIGN, "sparseSlab must fit in SPARSE_ROW_ALIGN");
+
+
+/* 配列の直前に置く隠しヘッダ */
+typedef struct {
+	size_t dims;
+	const size_t* sizes;   /* ブロック末尾に複製した各次元のサイズ */
+	size_t row_bytes;      /* 1行 (最下層の次元) のバイト数 */
+	size_t rows_per_slab;  /* 1枚のスラブから切り出す行数 */
+	size_t slab_used;      /* 先頭のスラブで使用済みの行数 */
+	size_t rows;           /* 実体化した行の総数 */
+	sparseSlab* slabs;     /* 最後に確保したスラブが先頭 */
+	const void* zero_row;  /* 全ての行が最初に指す共有のゼロ行 */
+	size_t zero_map_size;  /* ゼロ行を読み取り専用でマップした場合はそのバイト数 (ブロック内に置いた場合は0) */
+	uint32_t magic;
+} sparseHeader;
+
+_Static_assert(sizeof(sparseHeader) <= SPARSE_HEADER_SIZE, "sparseHeader must fit in SPARSE_HEADER_SIZE");
+
+
+static inline sparseHeader* header_of (const void* array) {
+	return (sparseHeader*)(void*)((uintptr_t)array - SPARSE_HEADER_SIZE);
+}
+
+
+/* 読み取り専用のゼロ行をマップする (読むだけならカーネルのゼロページが共有されるので物理メモリも消費しない) */
+static const void* map_zero_row (size_t row_bytes, size_t* map_size) {
+#ifdef ANDA_SPARSE_MMAP
+	long page = sysconf(_SC_PAGESIZE);
+	size_t size = anda_align_up(row_bytes, (page > 0) ? (size_t)page : 4096);
+	if (size != 0) {
+		void* map = mmap(PTR_NULL, size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (map != MAP_FAILED) {
+			*map_size = size;
+			return map;
+		}
+	}
+#else
+	(void)row_bytes;
+#endif
+	*map_size = 0;
+	return PTR_NULL;
+}
+
+
+static void* alloc_sparse_impl (const size_t sizes[], size_t dims, size_t elem_size) {
+	if (sizes == PTR_NULL || dims < 2 || dims > (SIZE_MAX / sizeof(size_t))) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_nd_array_size(sizes, dims, elem_size, &size_ptrs, &size_padding, &total_elements)) return PTR_NULL;
+
+	size_t row_bytes = sizes[dims - 1] * elem_size;  /* total_elements * elem_size が検証済みなので溢れない */
+	size_t size_sizes = dims * sizeof(size_t);
+	if (row_bytes > SIZE_MAX - SPARSE_ROW_ALIGN ||
+		size_ptrs > SIZE_MAX - SPARSE_HEADER_SIZE - size_sizes - SPARSE_ROW_ALIGN - row_bytes) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	/* ブロックは [隠しヘッダ][ポインタテーブル][サイズの複製][(マップできなかった場合の) ゼロ行] の順に並べる */
+	size_t map_size;
+	const void* zero_row = map_zero_row(row_bytes, &map_size);
+	size_t size_head = SPARSE_HEADER_SIZE + size_ptrs + size_sizes;
+	size_t zero_offset = anda_align_up(size_head, SPARSE_ROW_ALIGN);
+	size_t block_size = (zero_row != PTR_NULL) ? size_head : zero_offset + row_bytes;
+
+	char* block = malloc(block_size);
+	if (UNLIKELY(block == PTR_NULL)) {
+#ifdef ANDA_SPARSE_MMAP
+		if (zero_row != PTR_NULL) munmap((void*)(uintptr_t)zero_row, map_size);
+#endif
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+
+	if (zero_row == PTR_NULL) {
+		memset(block + zero_offset, 0, row_bytes);
+		zero_row = block + zero_offset;
+	}
+
+	char* array = block + SPARSE_HEADER_SIZE;
+	size_t* sizes_copy = (size_t*)(void*)(array + size_ptrs);
+	memcpy(sizes_copy, sizes, size_sizes);
+
+	/*
+	 * 要素サイズを0として上位の階層を組み立てると、最下層のポインタは全てポインタテーブルの直後を指す
+	 * (データ領域を持たないブロックの外を指すことがない)。その後で最下層を全てゼロ行に差し替える
+	 */
+	initialize_nd_array(array, sizes, dims, 0, size_ptrs, 0, total_elements);
+	size_t nrows = total_elements / sizes[dims - 1];
+	void** bottom = (void**)(void*)(array + size_ptrs) - nrows;
+	for (size_t i = 0; i < nrows; i++) {
+		bottom[i] = (void*)(uintptr_t)zero_row;
+	}
+
+	sparseHeader* header = header_of(array);
+	header->dims = dims;
+	header->sizes = sizes_copy;
+	header->row_bytes = row_bytes;
+	header->rows_per_slab = (row_bytes < ANDA_SPARSE_SLAB_BYTES) ? ANDA_SPARSE_SLAB_BYTES / row_bytes : 1;
+	header->slab_used = header->rows_per_slab;  /* 最初の行の実体化でスラブを確保させる */
+	header->rows = 0;
+	header->slabs = PTR_NULL;
+	header->zero_row = zero_row;
+	header->zero_map_size = map_size;
+	header->magic = SPARSE_MAGIC;
+	return array;
+}
+
+
+void* alloc_nd_array_sparse (const size_t sizes[], size_t dims, size_t elem_size) {
+	void* ptr = alloc_sparse_impl(sizes, dims, elem_size);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_nd_array_sparse";
+	return ptr;
+}
+
+
+/* スラブから新しい行を切り出す (スラブは calloc で確保し、行は再利用しないので常にゼロ) */
+static void* take_row (sparseHeader* header) {
+	if (header->slab_used == header->rows_per_slab) {
+		sparseSlab* slab = calloc(1, SPARSE_ROW_ALIGN + header->rows_per_slab * header->row_bytes);
+		if (UNLIKELY(slab == PTR_NULL)) {
+			errno = ENOMEM;
+			return PTR_NULL;
+		}
+		slab->next = header->slabs;
+		header->slabs = slab;
+		header->slab_used = 0;
+	}
+
+	char* row = (char*)header->slabs + SPARSE_ROW_ALIGN + header->slab_used * header->row_bytes;
+	header->slab_used++;
+	header->rows++;
+	return row;
+}
+
+
+void* materialize_nd_array_row (void* array, const size_t indices[]) {
+	if (array == PTR_NULL || indices == PTR_NULL || header_of(array)->magic != SPARSE_MAGIC) {
+		errno = EINVAL;
+		anda_errfunc = "materialize_nd_array_row";
+		return PTR_NULL;
+	}
+
+	sparseHeader* header = header_of(array);
+	void** table = array;
+	for (size_t d = 0; d + 1 < header->dims; d++) {
+		if (indices[d] >= header->sizes[d]) {
+			errno = EINVAL;
+			anda_errfunc = "materialize_nd_array_row";
+			return PTR_NULL;
+		}
+
+		if (d + 2 < header->dims) table = table[indices[d]];
+	}
+
+	void** slot = &table[indices[header->dims - 2]];
+	if (*slot == header->zero_row) {
+		void* row = take_row(header);
+		if (row == PTR_NULL) {
+			anda_errfunc = "materialize_nd_array_row";
+			return PTR_NULL;
+		}
+		*slot = row;
+	}
+
+	return *slot;
+}
+
+
+size_t get_nd_array_sparse_rows (const void* array) {
+	if (array == PTR_NULL || header_of(array)->magic != SPARSE_MAGIC) {
+		errno = EINVAL;
+		anda_errfunc = "get_nd_array_sparse_rows";
+		return 0;
+	}
+
+	return header_of(array)->rows;
+}
+
+
+void free_nd_array_sparse (void* array) {
+	if (array == PTR_NULL) return;
+
+	sparseHeader* header = header_of(array);
+	if (UNLIKELY(header->magic != SPARSE_MAGIC)) {
+		errno = EINVAL;
+		anda_errfunc = "free_nd_array_sparse";
+		return;
+	}
+
+	sparseSlab* slab = header->slabs;
+	while (slab != PTR_NULL) {
+		sparseSlab* next = slab->next;
+		free(slab);
+		slab = next;
+	}
+
+#ifdef ANDA_SPARSE_MMAP
+	if (header->zero_map_size != 0) munmap((void*)(uintptr_t)header->zero_row, header->zero_map_size);
+#endif
+
+	header->magic = 0;
+	free(header);
+}
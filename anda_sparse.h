@@ -0,0 +1,136 @@
+/*
+ * anda_sparse.h -- interface for multi-dimensional arrays whose rows are allocated on
+ *                  first write
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#pragma once
+
+#ifndef ANDA_SPARSE_H
+#define ANDA_SPARSE_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * A sparse array has the pointer tables of a standard array, but at first every
+ * bottom-level pointer refers to a single shared row of zeros. Reading any element
+ * therefore yields zero without a branch, and only the pointer tables take memory.
+ * On POSIX systems the zero row is mapped read-only, so a stray write faults instead
+ * of silently changing every untouched row.
+ *
+ * A row must be obtained with materialize_nd_array_row before it is written. The first
+ * call for a row takes fresh zeroed memory from slabs owned by the array and swaps the
+ * pointer; later calls just return the row. Memory thus grows with the number of rows
+ * actually written. The rows are not contiguous, so functions that depend on the
+ * standard layout (realloc_nd_array, clone_nd_array and the like) must not be used.
+ *
+ * Arrays allocated here must be released with free_nd_array_sparse. They are not
+ * thread-safe: threads that may materialize rows of the same array must serialize.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+/* Approximate size in bytes of each slab that materialized rows are taken from */
+#ifndef ANDA_SPARSE_SLAB_BYTES
+	#define ANDA_SPARSE_SLAB_BYTES ((size_t)64 << 10)
+#endif
+
+
+/*
+ * alloc_nd_array_sparse
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (must be 2 or more)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the multi-dimensional array or NULL on failure
+ * @note: After calling, cast the returned pointer to the appropriate type (e.g., int***, double**, etc.) to read it as the multi-dimensional array. Every element reads as zero until its row is materialized.
+ */
+extern void* alloc_nd_array_sparse (const size_t sizes[], size_t dims, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_nd_array_sparse_t
+ */
+#define alloc_nd_array_sparse_t(sizes, dims, elem_type) \
+	alloc_nd_array_sparse((sizes), (dims), sizeof(elem_type))
+
+
+/*
+ * materialize_nd_array_row
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_sparse
+ * @param indices: indices of the row in every dimension but the last (must have length equal to dims - 1)
+ * @return: pointer to the writable row, or NULL on failure
+ * @note: On the first call for a row, a zeroed row is allocated and the pointer table is updated, so the row is then also reachable through the array (e.g., a[i][j] for a 3-D array). Writes must only go through rows obtained this way.
+ */
+extern void* materialize_nd_array_row (void* array, const size_t indices[]);
+
+
+/*
+ * get_nd_array_sparse_rows
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_sparse
+ * @return: number of rows materialized so far (0 is also returned on error, with errno set)
+ */
+extern size_t get_nd_array_sparse_rows (const void* array);
+
+
+/*
+ * free_nd_array_sparse
+ * @param array: pointer to the multi-dimensional array allocated by alloc_nd_array_sparse (NULL is ignored)
+ * @note: this function releases the array together with all of its materialized rows
+ */
+extern void free_nd_array_sparse (void* array);
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif
@@ -0,0 +1,233 @@
+/*
+ * anda_tiled.c -- implementation of multi-dimensional arrays stored in square tiles
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+
+#include "anda_tiled.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "cver_compat.h"
+
+
+#define TILED_DATA_ALIGN 64  /* データ部分の先頭をキャッシュライン境界に揃える */
+
+
+/* 次元数に関係なく3次元として扱うための形状 (次元が足りない分は先頭側を大きさ1、タイル幅1で埋める) */
+typedef struct {
+	size_t n[3];      /* 各次元の大きさ */
+	size_t tb[3];     /* 各次元のタイル幅 */
+	size_t tiles[3];  /* 各次元のタイル数 */
+} tiledShape;
+
+
+static void get_shape (const ndArrayTiled* tiled, tiledShape* shape) {
+	size_t pad = 3 - tiled->dims;
+	for (size_t d = 0; d < 3; d++) {
+		bool used = (d >= pad);
+		shape->n[d] = used ? tiled->sizes[d - pad] : 1;
+		shape->tb[d] = used ? tiled->tile_size : 1;
+		shape->tiles[d] = used ? tiled->tiles[d - pad] : 1;
+	}
+}
+
+
+/* タイル番号からタイル先頭の添字と、配列内に収まる範囲を求める */
+static void locate_tile (const tiledShape* shape, size_t index, size_t origin[3], size_t extent[3]) {
+	size_t coord[3];
+	coord[2] = index % shape->tiles[2];
+	index /= shape->tiles[2];
+	coord[1] = index % shape->tiles[1];
+	coord[0] = index / shape->tiles[1];
+
+	for (size_t d = 0; d < 3; d++) {
+		origin[d] = coord[d] * shape->tb[d];
+		extent[d] = (shape->n[d] - origin[d] < shape->tb[d]) ? shape->n[d] - origin[d] : shape->tb[d];
+	}
+}
+
+
+static ndArrayTiled* alloc_tiled_impl (const size_t sizes[], size_t dims, size_t tile_size, size_t elem_size, bool zero_fill) {
+	if (sizes == PTR_NULL || dims == 0 || dims > ANDA_TILED_MAX_DIMS || elem_size == 0 ||
+		tile_size == 0 || (tile_size & (tile_size - 1)) != 0) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	unsigned int shift = 0;
+	while (((size_t)1 << shift) < tile_size) shift++;
+
+	/* 各次元をタイル幅の倍数に切り上げ、要素数を溢れないように掛け合わせる */
+	size_t tiles[ANDA_TILED_MAX_DIMS];
+	size_t total_tiles = 1, tile_elems = 1;
+	for (size_t d = 0; d < dims; d++) {
+		if (sizes[d] == 0 || sizes[d] > SIZE_MAX - (tile_size - 1)) {
+			errno = EINVAL;
+			return PTR_NULL;
+		}
+		tiles[d] = (sizes[d] + (tile_size - 1)) >> shift;
+		if (total_tiles > SIZE_MAX / tiles[d] || tile_elems > SIZE_MAX / tile_size) {
+			errno = EINVAL;
+			return PTR_NULL;
+		}
+		total_tiles *= tiles[d];
+		tile_elems *= tile_size;
+	}
+
+	size_t header_size = anda_align_up(sizeof(ndArrayTiled), TILED_DATA_ALIGN) + TILED_DATA_ALIGN;  /* malloc の返すアラインメントの不足分を含む */
+	if (total_tiles > SIZE_MAX / tile_elems || (total_tiles * tile_elems) > (SIZE_MAX - header_size) / elem_size) {
+		errno = EINVAL;
+		return PTR_NULL;
+	}
+
+	size_t data_size = total_tiles * tile_elems * elem_size;
+	char* block = zero_fill ? calloc(1, header_size + data_size) : malloc(header_size + data_size);
+	if (UNLIKELY(block == PTR_NULL)) {
+		errno = ENOMEM;
+		return PTR_NULL;
+	}
+
+	ndArrayTiled* tiled = (ndArrayTiled*)(void*)block;
+	uintptr_t data = ((uintptr_t)block + sizeof(ndArrayTiled) + (TILED_DATA_ALIGN - 1)) & ~(uintptr_t)(TILED_DATA_ALIGN - 1);
+	tiled->data = block + (data - (uintptr_t)block);
+	tiled->dims = dims;
+	tiled->elem_size = elem_size;
+	tiled->tile_size = tile_size;
+	tiled->tile_shift = shift;
+	for (size_t d = 0; d < ANDA_TILED_MAX_DIMS; d++) {
+		tiled->sizes[d] = (d < dims) ? sizes[d] : 0;
+		tiled->tiles[d] = (d < dims) ? tiles[d] : 0;
+	}
+	tiled->tile_elems = tile_elems;
+	tiled->total_tiles = total_tiles;
+
+	return tiled;
+}
+
+
+ndArrayTiled* alloc_nd_array_tiled (const size_t sizes[], size_t dims, size_t tile_size, size_t elem_size) {
+	ndArrayTiled* ptr = alloc_tiled_impl(sizes, dims, tile_size, elem_size, false);
+	if (ptr == PTR_NULL) anda_errfunc = "alloc_nd_array_tiled";
+	return ptr;
+}
+
+
+ndArrayTiled* calloc_nd_array_tiled (const size_t sizes[], size_t dims, size_t tile_size, size_t elem_size) {
+	ndArrayTiled* ptr = alloc_tiled_impl(sizes, dims, tile_size, elem_size, true);
+	if (ptr == PTR_NULL) anda_errfunc = "calloc_nd_array_tiled";
+	return ptr;
+}
+
+
+bool get_nd_array_tile (const ndArrayTiled* tiled, size_t index, ndArrayTile* result_tile) {
+	if (UNLIKELY(tiled == PTR_NULL || result_tile == PTR_NULL || index >= tiled->total_tiles)) {
+		errno = EINVAL;
+		anda_errfunc = "get_nd_array_tile";
+		return false;
+	}
+
+	tiledShape shape;
+	get_shape(tiled, &shape);
+	size_t origin[3], extent[3];
+	locate_tile(&shape, index, origin, extent);
+
+	/* 3次元として求めた結果を実際の次元数に詰め直す */
+	size_t pad = 3 - tiled->dims;
+	for (size_t d = 0; d < ANDA_TILED_MAX_DIMS; d++) {
+		result_tile->origin[d] = (d < tiled->dims) ? origin[d + pad] : 0;
+		result_tile->extent[d] = (d < tiled->dims) ? extent[d + pad] : 0;
+	}
+	result_tile->data = (char*)tiled->data + (index * tiled->tile_elems * tiled->elem_size);
+	return true;
+}
+
+
+/*
+ * 行優先の配列のデータ部分とタイル配置のデータの間で、タイルの1行ずつまとめてコピーする
+ * (src_flat が NULL でなければ src_flat からタイルへ、NULL ならタイルから dst_flat へ)
+ */
+static void convert_tiled (const ndArrayTiled* tiled, const char* src_flat, char* dst_flat) {
+	tiledShape shape;
+	get_shape(tiled, &shape);
+	size_t elem_size = tiled->elem_size;
+
+	for (size_t t = 0; t < tiled->total_tiles; t++) {
+		size_t origin[3], extent[3];
+		locate_tile(&shape, t, origin, extent);
+		char* tile = (char*)tiled->data + (t * tiled->tile_elems * elem_size);
+
+		for (size_t x = 0; x < extent[0]; x++) {
+			for (size_t y = 0; y < extent[1]; y++) {
+				size_t flat_index = ((((origin[0] + x) * shape.n[1]) + (origin[1] + y)) * shape.n[2]) + origin[2];
+				size_t tile_index = ((x * shape.tb[1]) + y) * shape.tb[2];
+				if (src_flat != PTR_NULL)
+					memcpy(tile + (tile_index * elem_size), src_flat + (flat_index * elem_size), extent[2] * elem_size);
+				else
+					memcpy(dst_flat + (flat_index * elem_size), tile + (tile_index * elem_size), extent[2] * elem_size);
+			}
+		}
+	}
+}
+
+
+/* alloc_nd_array と同じ配置の配列の、先頭からデータ部分までのオフセットを求める */
+static bool flat_data_offset (const ndArrayTiled* tiled, size_t* result) {
+	size_t size_ptrs, size_padding, total_elements;
+	if (!calculate_nd_array_size(tiled->sizes, tiled->dims, tiled->elem_size, &size_ptrs, &size_padding, &total_elements)) return false;
+	*result = size_ptrs + size_padding;
+	return true;
+}
+
+
+bool copy_nd_array_to_tiled (ndArrayTiled* dst, const void* src) {
+	size_t offset;
+	if (dst == PTR_NULL || src == PTR_NULL || !flat_data_offset(dst, &offset)) {
+		errno = EINVAL;
+		anda_errfunc = "copy_nd_array_to_tiled";
+		return false;
+	}
+
+	convert_tiled(dst, (const char*)src + offset, PTR_NULL);
+	return true;
+}
+
+
+bool copy_tiled_to_nd_array (void* dst, const ndArrayTiled* src) {
+	size_t offset;
+	if (dst == PTR_NULL || src == PTR_NULL || !flat_data_offset(src, &offset)) {
+		errno = EINVAL;
+		anda_errfunc = "copy_tiled_to_nd_array";
+		return false;
+	}
+
+	convert_tiled(src, PTR_NULL, (char*)dst + offset);
+	return true;
+}
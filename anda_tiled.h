@@ -0,0 +1,210 @@
+/*
+ * anda_tiled.h -- interface for multi-dimensional arrays stored in square tiles
+ * version 0.9.6, Oct. 16, 2026
+ *
+ * License: zlib License
+ *
+ * Copyright (c) 2026 Kazushi Yamasaki
+ *
+ * This software is provided ‘as-is’, without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software
+ * in a product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source
+ * distribution.
+ */
+
+
+#pragma once
+
+#ifndef ANDA_TILED_H
+#define ANDA_TILED_H
+
+
+
+#include "anda_macros.h"
+
+
+
+ANDA_CPP_C_BEGIN
+
+
+
+#include "alloc_nd_array.h"
+
+#include <stddef.h>
+#include <stdbool.h>
+
+
+
+/*
+ * A tiled array stores its 1D, 2D or 3D data as tiles of TB (TB x TB, TB x TB x TB)
+ * elements, where TB is a power of two. The tiles are placed one after another in
+ * row-major order of their tile coordinates, and each tile is itself dense and
+ * row-major, so a small neighbourhood of elements lives in a few cache lines even
+ * across rows. The shape is padded up to whole tiles.
+ *
+ * Since the elements are not reachable through pointer tables, a tiled array is
+ * described by an ndArrayTiled header stored at the start of the same block as its
+ * data, and its elements are addressed with the index functions below. The whole
+ * array is freed with a single free() of the header.
+ */
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-macros"
+#endif
+
+
+#define ANDA_TILED_MAX_DIMS 3
+
+
+typedef struct {
+	void* data;                          /* first element of the first tile (aligned to 64 bytes) */
+	size_t dims;                         /* number of dimensions (1 to ANDA_TILED_MAX_DIMS) */
+	size_t elem_size;                    /* size of each element in bytes */
+	size_t tile_size;                    /* TB, the edge length of a tile */
+	unsigned int tile_shift;             /* log2(TB) */
+	size_t sizes[ANDA_TILED_MAX_DIMS];   /* logical size of each dimension */
+	size_t tiles[ANDA_TILED_MAX_DIMS];   /* number of tiles along each dimension */
+	size_t tile_elems;                   /* elements per tile (TB to the power of dims) */
+	size_t total_tiles;                  /* number of tiles */
+} ndArrayTiled;
+
+
+typedef struct {
+	void* data;                            /* first element of the tile */
+	size_t origin[ANDA_TILED_MAX_DIMS];    /* array indices of the first element of the tile */
+	size_t extent[ANDA_TILED_MAX_DIMS];    /* number of elements of the tile that lie inside the array (smaller than TB for edge tiles) */
+} ndArrayTile;
+
+
+/*
+ * get_nd_array_tiled_index_2d
+ * @param tiled: pointer to a 2D tiled array
+ * @param i: row index
+ * @param j: column index
+ * @return: position of element (i, j) in tiled->data, in elements
+ */
+static inline size_t get_nd_array_tiled_index_2d (const ndArrayTiled* tiled, size_t i, size_t j) {
+	unsigned int s = tiled->tile_shift;
+	size_t m = tiled->tile_size - 1;
+	return ((((i >> s) * tiled->tiles[1]) + (j >> s)) << (2 * s)) + ((i & m) << s) + (j & m);
+}
+
+
+/*
+ * get_nd_array_tiled_index_3d
+ * @param tiled: pointer to a 3D tiled array
+ * @param i: index along the first dimension
+ * @param j: index along the second dimension
+ * @param k: index along the third dimension
+ * @return: position of element (i, j, k) in tiled->data, in elements
+ */
+static inline size_t get_nd_array_tiled_index_3d (const ndArrayTiled* tiled, size_t i, size_t j, size_t k) {
+	unsigned int s = tiled->tile_shift;
+	size_t m = tiled->tile_size - 1;
+	size_t tile = ((((i >> s) * tiled->tiles[1]) + (j >> s)) * tiled->tiles[2]) + (k >> s);
+	return (tile << (3 * s)) + ((((i & m) << s) + (j & m)) << s) + (k & m);
+}
+
+
+/* Element accessors (usable as lvalues), e.g. ANDA_TILED_AT_2D(t, double, i, j) = 1.0; */
+#define ANDA_TILED_AT_2D(tiled, elem_type, i, j) \
+	(((elem_type*)(tiled)->data)[get_nd_array_tiled_index_2d((tiled), (i), (j))])
+
+#define ANDA_TILED_AT_3D(tiled, elem_type, i, j, k) \
+	(((elem_type*)(tiled)->data)[get_nd_array_tiled_index_3d((tiled), (i), (j), (k))])
+
+
+/*
+ * alloc_nd_array_tiled
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (1 to ANDA_TILED_MAX_DIMS)
+ * @param tile_size: edge length of a tile in elements (must be a power of two, e.g., 8 or 16)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the tiled array or NULL on failure
+ * @note: Every dimension is padded up to a multiple of tile_size. The elements, including the padding, are uninitialized. The allocated memory must be freed using free() when no longer needed.
+ */
+extern ndArrayTiled* alloc_nd_array_tiled (const size_t sizes[], size_t dims, size_t tile_size, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * alloc_nd_array_tiled_t
+ */
+#define alloc_nd_array_tiled_t(sizes, dims, tile_size, elem_type) \
+	alloc_nd_array_tiled((sizes), (dims), (tile_size), sizeof(elem_type))
+
+
+/*
+ * calloc_nd_array_tiled
+ * @param sizes: array containing sizes for each dimension (must have length equal to dims)
+ * @param dims: number of array dimensions (1 to ANDA_TILED_MAX_DIMS)
+ * @param tile_size: edge length of a tile in elements (must be a power of two, e.g., 8 or 16)
+ * @param elem_size: size of each element in bytes (e.g., sizeof(int), sizeof(double), etc.)
+ * @return: pointer to the tiled array or NULL on failure
+ * @note: Same as alloc_nd_array_tiled, except that every element, including the padding, is set to zero.
+ */
+extern ndArrayTiled* calloc_nd_array_tiled (const size_t sizes[], size_t dims, size_t tile_size, size_t elem_size);
+
+/* A macro is available that automatically calculates the type size using sizeof(type).
+ *
+ * calloc_nd_array_tiled_t
+ */
+#define calloc_nd_array_tiled_t(sizes, dims, tile_size, elem_type) \
+	calloc_nd_array_tiled((sizes), (dims), (tile_size), sizeof(elem_type))
+
+
+/*
+ * get_nd_array_tile
+ * @param tiled: pointer to the tiled array
+ * @param index: index of the tile (0 to tiled->total_tiles - 1, in storage order)
+ * @param result_tile: pointer to store the location and extent of the tile
+ * @return: true if the tile was found, false if an error occurred
+ * @note: Iterating index from 0 to total_tiles - 1 visits the tiles in memory order. Inside a tile, element (a, b, c) relative to origin is at data[(((a * TB) + b) * TB) + c] (data[(a * TB) + b] in 2D), for a, b and c below the extent.
+ */
+extern bool get_nd_array_tile (const ndArrayTiled* tiled, size_t index, ndArrayTile* result_tile);
+
+
+/*
+ * copy_nd_array_to_tiled
+ * @param dst: pointer to the tiled array that receives the elements
+ * @param src: pointer to a multi-dimensional array allocated by alloc_nd_array or calloc_nd_array with the same sizes and element size
+ * @return: true if the elements were copied, false if an error occurred
+ * @note: The elements are copied in runs of up to one tile row at a time. The padding of dst is left untouched.
+ */
+extern bool copy_nd_array_to_tiled (ndArrayTiled* dst, const void* src);
+
+
+/*
+ * copy_tiled_to_nd_array
+ * @param dst: pointer to a multi-dimensional array allocated by alloc_nd_array or calloc_nd_array with the same sizes and element size
+ * @param src: pointer to the tiled array to copy from
+ * @return: true if the elements were copied, false if an error occurred
+ */
+extern bool copy_tiled_to_nd_array (void* dst, const ndArrayTiled* src);
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+	#pragma GCC diagnostic pop  /* -Wunused-macros */
+#endif
+
+
+ANDA_CPP_C_END
+
+
+
+#endif